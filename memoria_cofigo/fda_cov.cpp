@@ -0,0 +1,499 @@
+// fda_cov.cpp
+// Escritura en flujo y lectura del COV con metadatos FDA.
+
+#include "fda_cov.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ibex;
+
+namespace {
+
+const char FDA_COV_MAGIC[8] = {'F', 'D', 'A', 'C', 'O', 'V', 0, 0};
+const char FDA_COVZ_MAGIC[8] = {'F', 'D', 'A', 'C', 'O', 'V', 0, 'Z'};
+// Firma de la cabecera provisoria: el archivo de una escritura que no llegó
+// a finish() (corrida interrumpida) no se confunde con uno terminado.
+const char FDA_COV_PENDING_MAGIC[8] = {'F', 'D', 'A', 'C', 'O', 'V', 0, 'P'};
+const uint32_t FDA_COV_VERSION = 1;
+
+template <class T>
+void put(FILE* f, const T& v) { fwrite(&v, sizeof(T), 1, f); }
+
+// Campos de la cabecera después de la firma (ver fda_cov.h).
+struct Header {
+    uint32_t version = FDA_COV_VERSION;
+    uint32_t n = 0;
+    uint32_t goal_var = 0;
+    uint32_t extended = 1;
+    uint32_t status = 0;
+    uint32_t loup_point_empty = 1;
+    double uplo = NEG_INFINITY;
+    double uplo_of_epsboxes = POS_INFINITY;
+    double loup = POS_INFINITY;
+    double time = 0;
+    uint64_t nb_cells = 0;
+    uint64_t nb_boxes = 0;
+};
+
+void write_fields(FILE* f, const Header& h) {
+    put(f, h.version); put(f, h.n); put(f, h.goal_var); put(f, h.extended);
+    put(f, h.status); put(f, h.loup_point_empty);
+    put(f, h.uplo); put(f, h.uplo_of_epsboxes); put(f, h.loup); put(f, h.time);
+    put(f, h.nb_cells); put(f, h.nb_boxes);
+}
+
+template <class T>
+void write_at(char*& p, const T& v) {
+    memcpy(p, &v, sizeof(T));
+    p += sizeof(T);
+}
+
+template <class T>
+T read_at(const char*& p) {
+    T v;
+    memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return v;
+}
+
+void read_fields(const char*& p, Header& h) {
+    h.version = read_at<uint32_t>(p); h.n = read_at<uint32_t>(p);
+    h.goal_var = read_at<uint32_t>(p); h.extended = read_at<uint32_t>(p);
+    h.status = read_at<uint32_t>(p); h.loup_point_empty = read_at<uint32_t>(p);
+    h.uplo = read_at<double>(p); h.uplo_of_epsboxes = read_at<double>(p);
+    h.loup = read_at<double>(p); h.time = read_at<double>(p);
+    h.nb_cells = read_at<uint64_t>(p); h.nb_boxes = read_at<uint64_t>(p);
+}
+
+// Tamaño de la cabecera sin el loup-point.
+const size_t HEADER_SIZE = sizeof(FDA_COV_MAGIC) + 6 * sizeof(uint32_t) + 4 * sizeof(double) + 2 * sizeof(uint64_t);
+// Tamaño de una entrada sin la caja.
+const size_t RECORD_META_SIZE = 2 * sizeof(uint32_t) + 2 * sizeof(double);
+
+uint64_t bits(double x) {
+    uint64_t b;
+    memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+} // namespace
+
+bool is_fda_cov(const std::string& filename) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    char magic[sizeof(FDA_COV_MAGIC)];
+    bool ok = fread(magic, sizeof(magic), 1, f) == 1
+              && (memcmp(magic, FDA_COV_MAGIC, sizeof(magic)) == 0
+                  || memcmp(magic, FDA_COVZ_MAGIC, sizeof(magic)) == 0
+                  || memcmp(magic, FDA_COV_PENDING_MAGIC, sizeof(magic)) == 0);
+    fclose(f);
+    return ok;
+}
+
+FdaCovWriter::FdaCovWriter(const std::string& filename, int n, int goal_var, bool extended,
+                           bool compress)
+    : filename_(filename), n_(n), goal_var_(goal_var), extended_(extended), compress_(compress),
+      record_(RECORD_META_SIZE + 2 * (extended ? n + 1 : n) * sizeof(double)),
+      reference_(2 * (extended ? n + 1 : n), 0) {
+    file_ = fopen(filename.c_str(), "wb");
+    if (!file_) throw std::runtime_error("cannot write COV file " + filename);
+    setvbuf(file_, nullptr, _IOFBF, io_buffer_size);
+    if (compress_) {
+        memset(&zs_, 0, sizeof(zs_));
+        // Nivel rápido: la escritura ocurre al final de cada corrida.
+        if (deflateInit(&zs_, Z_BEST_SPEED) != Z_OK) {
+            fclose(file_); // sin destructor: el constructor no terminó
+            throw std::runtime_error("cannot initialize zlib");
+        }
+        zout_.resize(io_buffer_size);
+    }
+    // Cabecera provisoria (firma FDA_COV_PENDING_MAGIC): se reescribe en
+    // finish() con los resultados y la firma definitiva.
+    write_header(nullptr);
+}
+
+FdaCovWriter::~FdaCovWriter() {
+    if (file_) {
+        if (compress_) deflateEnd(&zs_);
+        fclose(file_);
+    }
+}
+
+void FdaCovWriter::set_reference(const IntervalVector& loup_point, double uplo, double loup) {
+    if (loup_point.is_empty()) return;
+    for (int i = 0, k = 0; i < (extended_ ? n_ + 1 : n_); i++) {
+        Interval x = (extended_ && i == goal_var_) ? Interval(uplo, loup) : loup_point[k++];
+        reference_[2 * i] = bits(x.lb());
+        reference_[2 * i + 1] = bits(x.ub());
+    }
+}
+
+void FdaCovWriter::write_header(const CovOptimData* data) {
+    Header h;
+    h.n = n_;
+    h.goal_var = goal_var_;
+    h.extended = extended_ ? 1 : 0;
+    h.nb_boxes = nb_boxes_;
+    std::vector<double> lp(2 * n_, 0.0);
+    if (data) {
+        h.status = data->data->_optim_optimizer_status;
+        h.uplo = data->uplo();
+        h.uplo_of_epsboxes = data->uplo_of_epsboxes();
+        h.loup = data->loup();
+        h.time = data->time();
+        h.nb_cells = data->nb_cells();
+        const IntervalVector& p = data->loup_point();
+        h.loup_point_empty = p.is_empty() ? 1 : 0;
+        if (!p.is_empty())
+            for (int i = 0; i < n_; i++) {
+                lp[2 * i] = p[i].lb();
+                lp[2 * i + 1] = p[i].ub();
+            }
+    }
+    const char* magic = !data ? FDA_COV_PENDING_MAGIC : compress_ ? FDA_COVZ_MAGIC : FDA_COV_MAGIC;
+    fwrite(magic, sizeof(FDA_COV_MAGIC), 1, file_);
+    write_fields(file_, h);
+    fwrite(lp.data(), sizeof(double), lp.size(), file_);
+    if (compress_)
+        fwrite(reference_.data(), sizeof(uint64_t), reference_.size(), file_);
+}
+
+void FdaCovWriter::deflate_out(const char* p, size_t len, int flush) {
+    zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(p));
+    zs_.avail_in = static_cast<uInt>(len);
+    do {
+        zs_.next_out = zout_.data();
+        zs_.avail_out = static_cast<uInt>(zout_.size());
+        deflate(&zs_, flush);
+        fwrite(zout_.data(), 1, zout_.size() - zs_.avail_out, file_);
+    } while (zs_.avail_out == 0);
+}
+
+void FdaCovWriter::add(const Cell& cell) {
+    char* p = record_.data();
+    write_at(p, static_cast<uint32_t>(cell.depth));
+    write_at(p, static_cast<int32_t>(cell.bisected_var));
+    write_at(p, cell.temperature);
+    write_at(p, cell.has_log_volume() ? cell.get_log_volume() : POS_INFINITY);
+    // Misma conversión que Optimizer::read_ext_box si no es extendido.
+    size_t k = 0;
+    for (int i = 0; i < cell.box.size(); i++) {
+        if (!extended_ && i == goal_var_) continue;
+        if (compress_) {
+            write_at(p, bits(cell.box[i].lb()) ^ reference_[k++]);
+            write_at(p, bits(cell.box[i].ub()) ^ reference_[k++]);
+        } else {
+            write_at(p, cell.box[i].lb());
+            write_at(p, cell.box[i].ub());
+        }
+    }
+    if (compress_)
+        deflate_out(record_.data(), record_.size(), Z_NO_FLUSH);
+    else
+        fwrite(record_.data(), 1, record_.size(), file_);
+    nb_boxes_++;
+}
+
+void FdaCovWriter::finish(const CovOptimData& data) {
+    if (compress_) {
+        deflate_out(nullptr, 0, Z_FINISH);
+        deflateEnd(&zs_);
+    }
+    if (fseek(file_, 0, SEEK_SET) != 0)
+        throw std::runtime_error("cannot write COV file " + filename_);
+    write_header(&data);
+    bool ok = !ferror(file_);
+    ok = fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    if (!ok) throw std::runtime_error("cannot write COV file " + filename_);
+}
+
+FdaCovMap::FdaCovMap(const std::string& filename) : filename_(filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot read COV file " + filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE) {
+        close(fd);
+        throw std::runtime_error("bad FDA COV file " + filename);
+    }
+    length_ = st.st_size;
+    void* m = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // el mapeo sigue válido
+    if (m == MAP_FAILED) throw std::runtime_error("cannot map COV file " + filename);
+    data_ = static_cast<const char*>(m);
+
+    const char* p = data_;
+    Header h;
+    bool compressed = memcmp(p, FDA_COVZ_MAGIC, sizeof(FDA_COVZ_MAGIC)) == 0;
+    bool ok = compressed || memcmp(p, FDA_COV_MAGIC, sizeof(FDA_COV_MAGIC)) == 0;
+    const char* why = "bad or truncated FDA COV file ";
+    if (memcmp(p, FDA_COV_PENDING_MAGIC, sizeof(FDA_COV_PENDING_MAGIC)) == 0)
+        why = "unfinished FDA COV file (interrupted run?) ";
+    p += sizeof(FDA_COV_MAGIC);
+    read_fields(p, h);
+    if (ok && h.version != FDA_COV_VERSION) {
+        ok = false;
+        why = "unsupported FDA COV version in ";
+    }
+    ok = ok && h.goal_var <= h.n;
+    n_ = h.n;
+    goal_var_ = h.goal_var;
+    extended_ = h.extended != 0;
+    nb_boxes_ = h.nb_boxes;
+    uplo_ = h.uplo;
+    record_size_ = RECORD_META_SIZE + 2 * dim() * sizeof(double);
+    records_ = data_ + HEADER_SIZE + 2 * n_ * sizeof(double);
+    if (compressed) {
+        // records_ apunta a la referencia; las entradas van después.
+        ok = ok && records_ + 2 * dim() * sizeof(double) <= data_ + length_;
+        if (ok) {
+            // Las páginas se leen una sola vez, en orden.
+            madvise(const_cast<char*>(data_), length_, MADV_SEQUENTIAL);
+            inflate_records(records_ + 2 * dim() * sizeof(double), data_ + length_);
+            ok = inflated_.size() == nb_boxes_ * record_size_;
+            records_ = inflated_.data();
+        }
+    } else {
+        // Un archivo truncado (escritura interrumpida) no se acepta.
+        ok = ok && records_ + nb_boxes_ * record_size_ <= data_ + length_;
+    }
+    if (!ok) {
+        munmap(const_cast<char*>(data_), length_);
+        data_ = nullptr;
+        throw std::runtime_error(why + filename);
+    }
+    if (!compressed)
+        // Las cajas se leen en orden; el kernel puede adelantar páginas.
+        madvise(const_cast<char*>(data_), length_, MADV_SEQUENTIAL);
+}
+
+void FdaCovMap::inflate_records(const char* begin, const char* end) {
+    std::vector<uint64_t> reference(2 * dim());
+    memcpy(reference.data(), records_, reference.size() * sizeof(uint64_t));
+
+    inflated_.resize(nb_boxes_ * record_size_);
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK) {
+        inflated_.clear(); // el llamador rechaza el archivo (y lo desmapea)
+        return;
+    }
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(begin));
+    zs.avail_in = static_cast<uInt>(end - begin);
+    zs.next_out = reinterpret_cast<Bytef*>(inflated_.data());
+    zs.avail_out = static_cast<uInt>(inflated_.size());
+    int ret = inflate(&zs, Z_FINISH);
+    size_t out = inflated_.size() - zs.avail_out;
+    inflateEnd(&zs);
+    if (ret != Z_STREAM_END) {
+        inflated_.resize(out == inflated_.size() ? 0 : out); // el llamador lo rechaza
+        return;
+    }
+
+    // Deshacer el XOR con la referencia.
+    for (size_t b = 0; b < nb_boxes_; b++) {
+        char* q = inflated_.data() + b * record_size_ + RECORD_META_SIZE;
+        for (size_t k = 0; k < reference.size(); k++, q += sizeof(uint64_t)) {
+            uint64_t v;
+            memcpy(&v, q, sizeof(v));
+            v ^= reference[k];
+            memcpy(q, &v, sizeof(v));
+        }
+    }
+}
+
+FdaCovMap::~FdaCovMap() {
+    if (data_) munmap(const_cast<char*>(data_), length_);
+}
+
+void FdaCovMap::box(size_t i, IntervalVector& box) const {
+    if (box.size() != dim()) box.resize(dim());
+    const char* p = record(i) + RECORD_META_SIZE;
+    for (int k = 0; k < dim(); k++) {
+        double lb = read_at<double>(p);
+        double ub = read_at<double>(p);
+        box[k] = Interval(lb, ub);
+    }
+}
+
+Optimizer::CellMeta FdaCovMap::meta(size_t i) const {
+    const char* p = record(i);
+    Optimizer::CellMeta m;
+    m.depth = read_at<uint32_t>(p);
+    m.bisected_var = read_at<int32_t>(p);
+    m.temperature = read_at<double>(p);
+    m.log_volume = read_at<double>(p);
+    return m;
+}
+
+double FdaCovMap::lb(size_t i) const {
+    if (!extended_) return uplo_;
+    const char* p = record(i) + RECORD_META_SIZE + 2 * goal_var_ * sizeof(double);
+    return read_at<double>(p);
+}
+
+CovOptimData* FdaCovMap::header_data() const {
+    const char* p = data_ + sizeof(FDA_COV_MAGIC);
+    Header h;
+    read_fields(p, h);
+
+    CovOptimData* data = new CovOptimData(dim(), extended_);
+    for (int i = 0; i < dim(); i++) data->data->_optim_var_names.push_back("");
+    data->data->_optim_optimizer_status = h.status;
+    data->data->_optim_uplo = h.uplo;
+    data->data->_optim_uplo_of_epsboxes = h.uplo_of_epsboxes;
+    data->data->_optim_loup = h.loup;
+    data->data->_optim_time = h.time;
+    data->data->_optim_nb_cells = static_cast<unsigned int>(h.nb_cells);
+
+    IntervalVector loup_point = IntervalVector::empty(n_);
+    if (!h.loup_point_empty)
+        for (int i = 0; i < n_; i++) {
+            double lb = read_at<double>(p);
+            double ub = read_at<double>(p);
+            loup_point[i] = Interval(lb, ub);
+        }
+    data->data->_optim_loup_point = loup_point;
+
+    // Por convención la primera caja es el loup-point (ver Optimizer::save_cov).
+    if (!h.loup_point_empty) {
+        IntervalVector box(dim());
+        for (int i = 0, k = 0; i < dim(); i++) {
+            if (extended_ && i == goal_var_) box[i] = Interval(h.uplo, h.loup);
+            else box[i] = loup_point[k++];
+        }
+        data->add(box);
+    }
+    return data;
+}
+
+CovOptimData* load_fda_cov(const std::string& filename, std::vector<Optimizer::CellMeta>& meta) {
+    FdaCovMap map(filename);
+    CovOptimData* data = map.header_data();
+
+    meta.clear();
+    meta.reserve(data->size() + map.size());
+    if (data->size() > 0)
+        meta.push_back(Optimizer::CellMeta{0, -1, Cell::temp_T0_, POS_INFINITY});
+
+    IntervalVector box(map.dim());
+    for (size_t i = 0; i < map.size(); i++) {
+        map.box(i, box);
+        data->add(box);
+        meta.push_back(map.meta(i));
+    }
+    return data;
+}
+
+LazyCovBuffer::LazyCovBuffer(CellBufferOptim& inner) : inner_(inner) {}
+
+void LazyCovBuffer::attach(std::shared_ptr<const FdaCovMap> map, CellMaker make_cell) {
+    map_ = std::move(map);
+    make_cell_ = std::move(make_cell);
+    order_.resize(map_->size());
+    for (size_t i = 0; i < order_.size(); i++) order_[i] = static_cast<uint32_t>(i);
+    // Sólo se leen las cotas (una por entrada), no las cajas.
+    std::vector<double> lbs(order_.size());
+    for (size_t i = 0; i < lbs.size(); i++) lbs[i] = map_->lb(i);
+    std::stable_sort(order_.begin(), order_.end(),
+                     [&lbs](uint32_t a, uint32_t b) { return lbs[a] < lbs[b]; });
+    next_ = 0;
+    end_ = order_.size();
+    materialized_ = 0;
+    box_.resize(map_->dim());
+}
+
+double LazyCovBuffer::pending_lb() const {
+    return next_ < end_ ? map_->lb(order_[next_]) : POS_INFINITY;
+}
+
+void LazyCovBuffer::refill() const {
+    // El orden por lb hace que la próxima pendiente sea la de menor cota:
+    // se crea si el buffer interno no tiene nada mejor (o está vacío).
+    while (next_ < end_ && (inner_.empty() || pending_lb() <= inner_.minimum())) {
+        size_t i = order_[next_++];
+        map_->box(i, box_);
+        Cell* c = make_cell_(box_, map_->meta(i));
+        materialized_++;
+        if (c) inner_.push(c);
+    }
+}
+
+void LazyCovBuffer::add_property(const IntervalVector& init_box, BoxProperties& prop) {
+    inner_.add_property(init_box, prop);
+}
+
+void LazyCovBuffer::flush() {
+    inner_.flush();
+    next_ = end_ = 0;
+}
+
+unsigned int LazyCovBuffer::size() const {
+    return inner_.size() + static_cast<unsigned int>(pending());
+}
+
+bool LazyCovBuffer::empty() const {
+    refill();
+    return inner_.empty();
+}
+
+void LazyCovBuffer::push(Cell* cell) {
+    inner_.push(cell);
+}
+
+Cell* LazyCovBuffer::pop() {
+    refill();
+    return inner_.pop();
+}
+
+Cell* LazyCovBuffer::top() const {
+    refill();
+    return inner_.top();
+}
+
+double LazyCovBuffer::minimum() const {
+    return std::min(inner_.minimum(), pending_lb());
+}
+
+void LazyCovBuffer::contract(double loup) {
+    inner_.contract(loup);
+    // Pendientes con lb > loup: el final del rango ordenado.
+    while (end_ > next_ && map_->lb(order_[end_ - 1]) > loup) end_--;
+}
+
+std::ostream& LazyCovBuffer::print(std::ostream& os) const {
+    os << "LazyCovBuffer(pending=" << pending() << ", cells=" << inner_.size() << ")";
+    return os;
+}
+
+void LazyCovBuffer::visit(const std::function<void(const Cell&)>& f) const {
+    if (const CellBufferVisitable* v = dynamic_cast<const CellBufferVisitable*>(&inner_)) {
+        v->visit(f);
+    } else {
+        // Sin forma de leerlo en el lugar: se vacía y se vuelve a llenar.
+        std::vector<Cell*> cells;
+        while (!inner_.empty()) {
+            Cell* c = inner_.top();
+            inner_.pop();
+            f(*c);
+            cells.push_back(c);
+        }
+        for (Cell* c : cells) inner_.push(c);
+    }
+    // Las pendientes se entregan como celdas temporales (sin propiedades).
+    for (size_t k = next_; k < end_; k++) {
+        size_t i = order_[k];
+        map_->box(i, box_);
+        Optimizer::CellMeta m = map_->meta(i);
+        Cell c(box_, m.bisected_var, m.depth);
+        c.temperature = m.temperature;
+        f(c);
+    }
+}
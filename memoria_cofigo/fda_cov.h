@@ -0,0 +1,200 @@
+// fda_cov.h
+// COV en flujo (--cov-stream): las celdas que quedan al final de la búsqueda
+// se escriben directo del buffer al archivo a medida que se extraen, en vez
+// de acumularse en el CovOptimData en memoria (que sólo guarda el loup-point).
+// El formato es propio, no el COV binario de Ibex, y lleva en cada entrada
+// los metadatos FDA de la celda (profundidad, temperatura, log-volumen).
+//
+// Formato (binario, con el orden de bytes de la máquina):
+//   cabecera de tamaño fijo, reescrita al cerrar (hasta entonces la firma
+//     es "FDACOV\0P" y el archivo no se puede leer):
+//     firma "FDACOV\0\0", versión, n, goal_var, extendido (0/1), status,
+//     uplo, uplo de eps-boxes, loup, tiempo, nb de celdas procesadas,
+//     nb de cajas, loup-point vacío (0/1) y loup-point (2n doubles);
+//   una entrada por caja: profundidad, variable bisectada, temperatura,
+//     log-volumen y la caja (2 doubles por componente; n+1 componentes si
+//     es extendido, n si no).
+//
+// Variante comprimida (--cov-compress, firma "FDACOV\0Z"): tras el loup-point
+// la cabecera lleva una caja de referencia (la del loup-point, 2 doubles por
+// componente) y las entradas van en un único flujo zlib. Cada cota se guarda
+// como el XOR de sus bits con la cota de la referencia: las cajas cercanas al
+// loup-point comparten signo, exponente y los primeros bits de mantisa, que
+// quedan en cero y se comprimen bien (y sin pérdida, a diferencia de restar).
+
+#pragma once
+
+#include "ibex.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+// True si el archivo empieza con la firma del formato (si no, es un COV de
+// Ibex). También con la de un archivo sin terminar, que FdaCovMap rechaza.
+bool is_fda_cov(const std::string& filename);
+
+class FdaCovWriter {
+public:
+    // n: número de variables originales; goal_var: índice del objetivo en la
+    // caja extendida. Con extended=false se escriben sólo las variables.
+    // Abre el archivo y reserva la cabecera.
+    FdaCovWriter(const std::string& filename, int n, int goal_var, bool extended,
+                 bool compress = false);
+    ~FdaCovWriter();
+
+    FdaCovWriter(const FdaCovWriter&) = delete;
+    FdaCovWriter& operator=(const FdaCovWriter&) = delete;
+
+    // Referencia de la codificación comprimida: el loup-point (n componentes)
+    // con el objetivo en [uplo, loup]. Llamar antes de la primera celda; sin
+    // referencia (o sin loup-point) las cotas se guardan tal cual.
+    void set_reference(const ibex::IntervalVector& loup_point, double uplo, double loup);
+
+    // Escribe una celda (caja extendida, como en el buffer del Optimizer).
+    void add(const ibex::Cell& cell);
+
+    // Completa la cabecera con los resultados de la búsqueda (status, loup,
+    // uplo, tiempo, ...) y cierra el archivo.
+    void finish(const ibex::CovOptimData& data);
+
+    size_t size() const { return nb_boxes_; }
+
+private:
+    // Buffer de escritura de stdio (las entradas son pequeñas).
+    static constexpr size_t io_buffer_size = 1 << 20;
+
+    std::string filename_;
+    FILE* file_ = nullptr;
+    int n_;
+    int goal_var_;
+    bool extended_;
+    bool compress_;
+    uint64_t nb_boxes_ = 0;
+    // Entrada codificada y, si se comprime, bits de la referencia y salida zlib.
+    std::vector<char> record_;
+    std::vector<uint64_t> reference_;
+    z_stream zs_;
+    std::vector<unsigned char> zout_;
+
+    void write_header(const ibex::CovOptimData* data);
+    void deflate_out(const char* p, size_t len, int flush);
+};
+
+// Archivo en formato FDA mapeado en memoria (sólo lectura): las cajas se
+// leen en el lugar, sin cargar el archivo completo. La variante comprimida
+// se descomprime entera al abrir: ocupa en memoria el tamaño sin comprimir
+// (nb de cajas × tamaño de entrada), que no se libera hasta destruir el
+// mapa. Descomprimir por partes no sirve a LazyCovBuffer, que recorre las
+// cajas en orden de cota inferior, no en el del archivo (un flujo zlib no
+// admite acceso aleatorio). Lo que LazyCovBuffer ahorra con un archivo
+// comprimido son las celdas (mucho más grandes que una entrada), no las
+// entradas mismas.
+class FdaCovMap {
+public:
+    explicit FdaCovMap(const std::string& filename);
+    ~FdaCovMap();
+
+    FdaCovMap(const FdaCovMap&) = delete;
+    FdaCovMap& operator=(const FdaCovMap&) = delete;
+
+    int nb_var() const { return n_; }
+    bool extended() const { return extended_; }
+    // Dimensión de las cajas del archivo (n+1 si es extendido).
+    int dim() const { return extended_ ? n_ + 1 : n_; }
+    size_t size() const { return nb_boxes_; }
+
+    // Caja i (dimensión dim()) y sus metadatos.
+    void box(size_t i, ibex::IntervalVector& box) const;
+    ibex::Optimizer::CellMeta meta(size_t i) const;
+    // Cota inferior del objetivo en la caja i (uplo del archivo si no es extendido).
+    double lb(size_t i) const;
+
+    // Datos de la búsqueda guardada (status, loup, uplo, ...) con el loup-point
+    // como única caja: lo que Optimizer::start necesita antes de las celdas.
+    ibex::CovOptimData* header_data() const;
+
+private:
+    std::string filename_;
+    const char* data_ = nullptr;
+    size_t length_ = 0;
+    int n_ = 0;
+    int goal_var_ = 0;
+    bool extended_ = true;
+    size_t nb_boxes_ = 0;
+    double uplo_ = ibex::NEG_INFINITY;
+    size_t record_size_ = 0;
+    const char* records_ = nullptr;
+    // Entradas descomprimidas (variante comprimida); records_ apunta aquí.
+    std::vector<char> inflated_;
+
+    void inflate_records(const char* begin, const char* end);
+
+    const char* record(size_t i) const { return records_ + i * record_size_; }
+};
+
+// Lee un archivo completo como lo dejaría Optimizer::save_cov: el loup-point
+// primero (si existe) y luego las cajas, con sus metadatos en el mismo orden.
+ibex::CovOptimData* load_fda_cov(const std::string& filename,
+                                 std::vector<ibex::Optimizer::CellMeta>& meta);
+
+// Buffer que retoma una búsqueda desde un FdaCovMap sin crear todas las celdas
+// al inicio: las cajas pendientes se recorren en orden de cota inferior y una
+// caja se convierte en celda (y se contrae, ver Optimizer::make_cov_cell)
+// recién cuando su cota no supera el mínimo del buffer interno o éste se
+// vacía. Para el Optimizer el buffer contiene todas las cajas (size, minimum,
+// contract las incluyen). Sólo modo secuencial: las celdas se crean con los
+// operadores del Optimizer que llama a top()/pop(). Una caja pendiente no es
+// candidata a la selección del buffer interno hasta que se crea: con un
+// buffer que no elige por cota inferior (TempBuffer) el orden de exploración
+// cambia, por eso fda_runner sólo lo usa en modo base.
+class LazyCovBuffer : public ibex::CellBufferOptim, public ibex::CellBufferVisitable {
+public:
+    // Crea la celda de una caja del archivo (NULL si se vacía al contraerla).
+    using CellMaker = std::function<ibex::Cell*(const ibex::IntervalVector&,
+                                                const ibex::Optimizer::CellMeta&)>;
+
+    explicit LazyCovBuffer(ibex::CellBufferOptim& inner);
+
+    // Toma como pendientes todas las cajas del archivo (el loup-point va en la
+    // cabecera). Llamar después de Optimizer::start, que vacía el buffer.
+    void attach(std::shared_ptr<const FdaCovMap> map, CellMaker make_cell);
+
+    void add_property(const ibex::IntervalVector& init_box, ibex::BoxProperties& prop) override;
+    void flush() override;
+    unsigned int size() const override;
+    bool empty() const override;
+    void push(ibex::Cell* cell) override;
+    ibex::Cell* pop() override;
+    ibex::Cell* top() const override;
+    double minimum() const override;
+    void contract(double loup) override;
+    std::ostream& print(std::ostream& os) const override;
+
+    // Celdas del buffer interno y cajas pendientes (como celdas temporales).
+    void visit(const std::function<void(const ibex::Cell&)>& f) const override;
+
+    size_t pending() const { return end_ - next_; }
+    size_t materialized() const { return materialized_; }
+
+private:
+    ibex::CellBufferOptim& inner_;
+    std::shared_ptr<const FdaCovMap> map_;
+    CellMaker make_cell_;
+    // Índices de las cajas pendientes ordenados por lb; pendientes: [next_, end_).
+    std::vector<uint32_t> order_;
+    // top()/empty() son const en Ibex pero pueden crear celdas pendientes.
+    mutable size_t next_ = 0;
+    mutable size_t end_ = 0;
+    mutable size_t materialized_ = 0;
+    mutable ibex::IntervalVector box_{1};
+
+    double pending_lb() const;
+    // Crea las celdas pendientes que el buffer interno necesita ya.
+    void refill() const;
+};
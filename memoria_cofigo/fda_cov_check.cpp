@@ -0,0 +1,267 @@
+// fda_cov_check.cpp
+// Verificación del formato de fda_cov.h (ctest: fda_cov_roundtrip). Escribe
+// archivos con FdaCovWriter, los vuelve a leer con FdaCovMap y load_fda_cov
+// y compara cajas, metadatos y cabecera bit a bit. Termina con código 1 si
+// algo no coincide.
+//
+// Casos: plano y comprimido (XOR con la caja de referencia), extendido y no
+// extendido (sin la componente goal_var), con y sin loup-point; y archivos
+// que el lector debe rechazar: truncado, sin terminar (sin finish()) y con
+// una versión desconocida.
+
+#include "fda_cov.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+using namespace ibex;
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Variables originales y posición del objetivo en la caja extendida (al
+// medio, para que saltarla en el formato no extendido se note).
+const int N = 3;
+const int GOAL = 1;
+const int NB_CELLS = 50;
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+bool same_bits(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+bool same_bits(const Interval& a, const Interval& b) {
+    return same_bits(a.lb(), b.lb()) && same_bits(a.ub(), b.ub());
+}
+
+struct Case {
+    string name;
+    bool extended;
+    bool compress;
+    bool loup_point;
+};
+
+// Resultados de la búsqueda que se guardan en la cabecera.
+const unsigned int STATUS = 3;
+const double UPLO = -1.5;
+const double UPLO_EPS = -1.25;
+const double LOUP = -1.0;
+const double TIME = 12.5;
+const unsigned int NB_PROCESSED = 12345;
+
+IntervalVector loup_point() {
+    IntervalVector p(N);
+    p[0] = Interval(0.125, 0.125);
+    p[1] = Interval(-3.0, -2.999);
+    p[2] = Interval(1e-300, 2e-300);
+    return p;
+}
+
+// Caja extendida de la celda j: cerca del loup-point (el caso que la
+// codificación XOR comprime), lejos, y con cotas especiales.
+IntervalVector cell_box(int j) {
+    IntervalVector lp = loup_point();
+    IntervalVector box(N + 1);
+    for (int i = 0, k = 0; i < N + 1; i++) {
+        if (i == GOAL) {
+            box[i] = Interval(UPLO + j * 1e-3, LOUP);
+            continue;
+        }
+        double c = lp[k++].lb();
+        if (j % 10 == 7)
+            box[i] = Interval(NEG_INFINITY, POS_INFINITY);
+        else if (j % 10 == 8)
+            box[i] = Interval(-0.0, 4.9e-324); // cero negativo y subnormal
+        else if (j % 2)
+            box[i] = Interval(c - j * 1e6, c + j * 1e6);
+        else
+            box[i] = Interval(c - j * 1e-9, c + j * 1e-9);
+    }
+    return box;
+}
+
+Optimizer::CellMeta cell_meta(int j) {
+    // Sin log-volumen en caché (POS_INFINITY) una de cada tres.
+    return Optimizer::CellMeta{static_cast<unsigned int>(j), j % 4 - 1, 100.0 / (j + 1),
+                               j % 3 == 0 ? POS_INFINITY : -2.5 * j};
+}
+
+// Caja tal como queda en el archivo (sin goal_var si no es extendido).
+IntervalVector file_box(int j, bool extended) {
+    IntervalVector box = cell_box(j);
+    if (extended) return box;
+    IntervalVector b(N);
+    for (int i = 0, k = 0; i < N + 1; i++)
+        if (i != GOAL) b[k++] = box[i];
+    return b;
+}
+
+void write(const string& file, const Case& c) {
+    int dim = c.extended ? N + 1 : N;
+    CovOptimData data(dim, c.extended);
+    data.data->_optim_optimizer_status = STATUS;
+    data.data->_optim_uplo = UPLO;
+    data.data->_optim_uplo_of_epsboxes = UPLO_EPS;
+    data.data->_optim_loup = LOUP;
+    data.data->_optim_time = TIME;
+    data.data->_optim_nb_cells = NB_PROCESSED;
+    data.data->_optim_loup_point = c.loup_point ? loup_point() : IntervalVector::empty(N);
+
+    FdaCovWriter w(file, N, GOAL, c.extended, c.compress);
+    if (c.compress) w.set_reference(data.loup_point(), UPLO, LOUP);
+    for (int j = 0; j < NB_CELLS; j++) {
+        Optimizer::CellMeta m = cell_meta(j);
+        Cell cell(cell_box(j), m.bisected_var, m.depth);
+        cell.temperature = m.temperature;
+        cell.restore_log_volume(m.log_volume);
+        w.add(cell);
+    }
+    w.finish(data);
+}
+
+void check_meta(const Optimizer::CellMeta& m, const Optimizer::CellMeta& e, const string& what) {
+    check(m.depth == e.depth && m.bisected_var == e.bisected_var
+          && same_bits(m.temperature, e.temperature) && same_bits(m.log_volume, e.log_volume),
+          what + ": metadata");
+}
+
+void check_case(const string& dir, const Case& c) {
+    string file = dir + "/" + c.name + ".cov";
+    write(file, c);
+    check(is_fda_cov(file), c.name + ": signature");
+
+    FdaCovMap map(file);
+    check(map.nb_var() == N && map.extended() == c.extended && map.size() == NB_CELLS,
+          c.name + ": dimensions");
+    IntervalVector box(1);
+    for (int j = 0; j < NB_CELLS && j < static_cast<int>(map.size()); j++) {
+        string what = c.name + ": box " + to_string(j);
+        IntervalVector e = file_box(j, c.extended);
+        map.box(j, box);
+        bool same = box.size() == e.size();
+        for (int i = 0; same && i < e.size(); i++) same = same_bits(box[i], e[i]);
+        check(same, what);
+        check_meta(map.meta(j), cell_meta(j), what);
+        check(same_bits(map.lb(j), c.extended ? e[GOAL].lb() : UPLO), what + ": lb");
+    }
+
+    vector<Optimizer::CellMeta> meta;
+    unique_ptr<CovOptimData> data(load_fda_cov(file, meta));
+    int first = c.loup_point ? 1 : 0;
+    check(data->size() == static_cast<size_t>(NB_CELLS + first) && meta.size() == data->size(),
+          c.name + ": loaded size");
+    check(data->is_extended_space() == c.extended, c.name + ": loaded layout");
+    check(data->optimizer_status() == STATUS && data->nb_cells() == NB_PROCESSED
+          && same_bits(data->uplo(), UPLO) && same_bits(data->uplo_of_epsboxes(), UPLO_EPS)
+          && same_bits(data->loup(), LOUP) && same_bits(data->time(), TIME),
+          c.name + ": header");
+
+    const IntervalVector& lp = data->loup_point();
+    if (c.loup_point) {
+        IntervalVector e = loup_point();
+        bool same = lp.size() == N && !lp.is_empty();
+        for (int i = 0; same && i < N; i++) same = same_bits(lp[i], e[i]);
+        check(same, c.name + ": loup-point");
+        // Por convención la primera caja es el loup-point.
+        const IntervalVector& b = (*data)[0];
+        same = b.size() == map.dim();
+        for (int i = 0, k = 0; same && i < b.size(); i++) {
+            if (c.extended && i == GOAL) same = same_bits(b[i], Interval(UPLO, LOUP));
+            else same = same_bits(b[i], e[k++]);
+        }
+        check(same, c.name + ": loup-point box");
+    } else {
+        check(lp.is_empty(), c.name + ": empty loup-point");
+    }
+    for (int j = 0; j < NB_CELLS && first + j < static_cast<int>(data->size()); j++) {
+        IntervalVector e = file_box(j, c.extended);
+        const IntervalVector& b = (*data)[first + j];
+        bool same = b.size() == e.size();
+        for (int i = 0; same && i < e.size(); i++) same = same_bits(b[i], e[i]);
+        check(same, c.name + ": loaded box " + to_string(j));
+        check_meta(meta[first + j], cell_meta(j), c.name + ": loaded box " + to_string(j));
+    }
+}
+
+void check_rejected(const string& file, const string& what) {
+    try {
+        FdaCovMap map(file);
+        check(false, what + ": accepted");
+    } catch (std::runtime_error&) {
+    }
+}
+
+void check_bad_files(const string& dir) {
+    // Truncado: falta el final de la última entrada (o del flujo zlib).
+    for (bool compress : {false, true}) {
+        string file = dir + (compress ? "/truncated_z.cov" : "/truncated.cov");
+        write(file, Case{"", true, compress, true});
+        fs::resize_file(file, fs::file_size(file) - 1);
+        check_rejected(file, file);
+    }
+
+    // Escritura que no llegó a finish() (corrida interrumpida).
+    string file = dir + "/unfinished.cov";
+    {
+        FdaCovWriter w(file, N, GOAL, true);
+        w.add(Cell(cell_box(0)));
+    }
+    check(is_fda_cov(file), "unfinished: signature");
+    check_rejected(file, "unfinished");
+
+    // Versión desconocida (el campo sigue a la firma de 8 bytes).
+    file = dir + "/version.cov";
+    write(file, Case{"", true, false, true});
+    {
+        fstream f(file, ios::in | ios::out | ios::binary);
+        uint32_t version = 99;
+        f.seekp(8);
+        f.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    check_rejected(file, "unknown version");
+}
+
+} // namespace
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / "fda_cov_check";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    const Case cases[] = {
+        {"plain", true, false, true},
+        {"plain_no_ext", false, false, true},
+        {"plain_no_loup", true, false, false},
+        {"xor", true, true, true},
+        {"xor_no_ext", false, true, true},
+        {"xor_no_loup", true, true, false},
+    };
+    try {
+        for (const Case& c : cases) check_case(dir.string(), c);
+        check_bad_files(dir.string());
+    } catch (std::exception& e) {
+        check(false, e.what());
+    }
+
+    fs::remove_all(dir);
+    if (failures) {
+        cerr << failures << " check(s) failed" << endl;
+        return 1;
+    }
+    cout << "fda_cov: ok" << endl;
+    return 0;
+}
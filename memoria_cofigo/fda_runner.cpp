@@ -0,0 +1,691 @@
+// fda_runner.cpp
+// Corrida de ibex_opt_full (antes el cuerpo de su main).
+
+#include "fda_runner.h"
+
+#include "ibex_OptimLargestFirst.h"
+#include "parallel_optimizer.h"
+#include "sharded_temp_buffer.h"
+#include "fda_cov.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+using namespace std;
+using namespace ibex;
+
+namespace {
+
+// Parser Minibex y capa simbólica de Ibex (no reentrantes): la lectura del
+// sistema, la configuración y su destrucción se hacen con este lock.
+std::mutex setup_mutex;
+
+// Simple subclass to expose protected getters from DefaultOptimizerConfig.
+// The cell buffer can be replaced (shared buffer of the parallel mode).
+struct FdConfig : public DefaultOptimizerConfig {
+    using DefaultOptimizerConfig::DefaultOptimizerConfig;
+    using DefaultOptimizerConfig::nb_var;
+    using DefaultOptimizerConfig::get_ctc;
+    using DefaultOptimizerConfig::get_bsc;
+    using DefaultOptimizerConfig::get_loup_finder;
+    using DefaultOptimizerConfig::goal_var;
+    using DefaultOptimizerConfig::get_ext_sys;
+    using DefaultOptimizerConfig::get_norm_sys;
+    using DefaultOptimizerConfig::get_eps_x;
+    using DefaultOptimizerConfig::get_rel_eps_f;
+    using DefaultOptimizerConfig::get_abs_eps_f;
+    using DefaultOptimizerConfig::with_statistics;
+    using DefaultOptimizerConfig::get_trace;
+    using DefaultOptimizerConfig::get_timeout;
+    using DefaultOptimizerConfig::with_extended_cov;
+
+    CellBufferOptim& get_cell_buffer() override {
+        return buffer_override ? *buffer_override : DefaultOptimizerConfig::get_cell_buffer();
+    }
+    CellBufferOptim& get_default_cell_buffer() { return DefaultOptimizerConfig::get_cell_buffer(); }
+
+    CellBufferOptim* buffer_override = nullptr;
+};
+
+// Ejecuta f (la búsqueda) sin el lock de configuración; al volver, también
+// por excepción, el lock está tomado otra vez para destruir la corrida.
+template <typename F>
+void unlocked(std::unique_lock<std::mutex>& lock, F f) {
+    lock.unlock();
+    try {
+        f();
+    } catch (...) {
+        lock.lock();
+        throw;
+    }
+    lock.lock();
+}
+
+void run(const FdaRunOptions& opt, System* sys, std::unique_lock<std::mutex>& lock, FdaRunResult& res) {
+    const bool quiet = opt.quiet;
+
+    FdConfig config(*sys);
+
+    string output_cov_file; // cov output file
+    bool overwitten = false;  // is it overwritten?
+    string cov_copy;
+
+    if (!sys->goal) {
+        res.error = "input file has not goal (it is not an optimization problem).";
+        return;
+    }
+
+    const string& fd_choice = opt.fd_mode;
+    bool use_fd_variant = (fd_choice=="depth_k" || fd_choice=="depth_k_rand" ||
+                           fd_choice=="vol_k"   || fd_choice=="vol_k_rand");
+
+    bool want_fd_logging = use_fd_variant && !quiet;
+    if (want_fd_logging) {
+        cout << "  [fd-debug] sys.box empty? " << (sys->box.is_empty() ? "yes" : "no")
+             << " unbounded? " << (sys->box.is_unbounded() ? "yes" : "no")
+             << " dim=" << sys->nb_var << "\n";
+        if (!sys->box.is_empty() && !sys->box.is_unbounded()) {
+            try {
+                cout << "  [fd-debug] root volume: " << sys->box.volume() << "\n";
+            } catch (...) {
+                cout << "  [fd-debug] root volume: (error computing)\n";
+            }
+        }
+    }
+
+    if (!quiet) {
+        cout << endl << "************************ setup ************************" << endl;
+        cout << "  file loaded:\t\t" << opt.filename << endl;
+        if (opt.rel_eps_f)
+            cout << "  rel-eps-f:\t\t" << *opt.rel_eps_f << "\t(relative precision on objective)" << endl;
+        if (opt.abs_eps_f)
+            cout << "  abs-eps-f:\t\t" << *opt.abs_eps_f << "\t(absolute precision on objective)" << endl;
+        if (opt.eps_h)
+            cout << "  eps-h:\t\t" << *opt.eps_h << "\t(equality thickening)" << endl;
+        if (opt.eps_x)
+            cout << "  eps-x:\t\t" << *opt.eps_x << "\t(precision on variables domain)" << endl;
+    }
+
+    Vector eps_x(sys->nb_var, opt.eps_x ? *opt.eps_x : OptimizerConfig::default_eps_x);
+
+    if (!opt.no_split.empty()) {
+        if (!quiet)
+            cout << "  don't split:\t\t";
+
+        vector<const ExprNode*> no_split = parse_symbols_list(sys->args, opt.no_split);
+
+        if (!quiet) {
+            for (vector<const ExprNode*>::const_iterator it=no_split.begin(); it!=no_split.end(); ++it)
+                cout << **it << ' ';
+            cout << endl;
+        }
+
+        if (!no_split.empty()) {
+            // we use VarSet for convenience (handling of indexed symbols)
+            VarSet varset(sys->f_ctrs, no_split, true);
+
+            for (int i=0; i<varset.nb_var; i++) {
+                eps_x[varset.var(i)] = POS_INFINITY;
+            }
+            for (vector<const ExprNode*>::iterator it=no_split.begin(); it!=no_split.end(); ++it) {
+                cleanup(**it, false);
+            }
+        }
+    }
+
+    if (!quiet) {
+        // This option certifies feasibility with equalities
+        if (opt.rigor)
+            cout << "  rigor mode:\t\tON\t(feasibility of equalities certified)" << endl;
+        if (opt.kkt)
+            cout << "  KKT contractor:\tON" << endl;
+        if (opt.simpl_level)
+            cout << "  symbolic simpl level:\t" << *opt.simpl_level << "\t" << endl;
+        if (opt.initial_loup)
+            cout << "  initial loup:\t\t" << *opt.initial_loup << " (a priori upper bound of the minimum)" << endl;
+        // Fix the random seed for reproducibility.
+        if (opt.random_seed)
+            cout << "  random seed:\t\t" << *opt.random_seed << endl;
+    }
+
+    if (!opt.input_file.empty() && !opt.resume.empty()) {
+        res.error = "--input and --resume cannot be used together";
+        return;
+    }
+    if (!fda_threaded_search && (opt.threads > 1 || opt.async_loup)) {
+        res.error = "--threads N>1 and --async-loup need an Ibex build with a per-thread RNG (FDA_THREAD_LOCAL_RNG)";
+        return;
+    }
+    // Con KKT el contractor evalúa las Function del NormalizedSystem que usa
+    // también el loup finder: no pueden ir en hilos distintos.
+    if (opt.async_loup && opt.kkt) {
+        res.error = "--async-loup cannot be used with --kkt";
+        return;
+    }
+
+    // --resume es un --input que además sigue guardando checkpoints.
+    string input_cov = !opt.input_file.empty() ? opt.input_file : opt.resume;
+    string checkpoint_cov = !opt.checkpoint.empty() ? opt.checkpoint : opt.resume;
+
+    if (!input_cov.empty() && !quiet)
+        cout << "  input COV file:\t" << input_cov << "\n";
+
+    if (!opt.save_cov) {
+        // Sin COV de salida: no se toca el archivo de una corrida anterior.
+    } else if (!opt.output_file.empty()) {
+        output_cov_file = opt.output_file;
+    } else {
+        // got from stackoverflow.com:
+        string::size_type const p(opt.filename.find_last_of('.'));
+        // filename without extension
+        string filename_no_ext = opt.filename.substr(0, p);
+        stringstream ss;
+        ss << filename_no_ext << ".cov";
+        output_cov_file = ss.str();
+
+        // El COV anterior se renombra en vez de copiarse (no se relee ni se
+        // reescribe). Su archivo de metadatos (.fda) lo acompaña.
+        std::error_code ec;
+        if (std::filesystem::exists(output_cov_file, ec)) {
+            cov_copy = output_cov_file + "~";
+            std::filesystem::rename(output_cov_file, cov_copy, ec);
+            if (ec) {
+                res.error = "cannot rename " + output_cov_file + ": " + ec.message();
+                return;
+            }
+            overwitten = true;
+            if (std::filesystem::exists(output_cov_file + ".fda", ec))
+                std::filesystem::rename(output_cov_file + ".fda", cov_copy + ".fda", ec);
+            else
+                std::filesystem::remove(cov_copy + ".fda", ec);
+            // Retomar desde el COV de salida: se lee la copia.
+            if (input_cov == output_cov_file) input_cov = cov_copy;
+        }
+    }
+
+    if (!quiet) {
+        if (opt.save_cov)
+            cout << "  output COV file:\t" << output_cov_file << "\n";
+        // This option limits the search time
+        if (opt.timeout)
+            cout << "  timeout:\t\t" << *opt.timeout << "s" << endl;
+        // This option prints each better feasible point when it is found
+        if (opt.trace)
+            cout << "  trace:\t\tON" << endl;
+        // This option enables statistics
+        if (opt.stats)
+            cout << "  statistics:\t\tON" << endl;
+    }
+
+    int nb_threads = std::max(1, opt.threads);
+    if (nb_threads>1 && !quiet)
+        cout << "  threads:\t\t" << nb_threads << endl;
+
+    // Same settings for the main configuration and those of the workers.
+    auto apply_settings = [&](FdConfig& c) {
+        if (opt.rel_eps_f) c.set_rel_eps_f(*opt.rel_eps_f);
+        if (opt.abs_eps_f) c.set_abs_eps_f(*opt.abs_eps_f);
+        if (opt.eps_h) c.set_eps_h(*opt.eps_h);
+        c.set_eps_x(eps_x);
+        if (opt.rigor) c.set_rigor(true);
+        if (opt.kkt) c.set_kkt(true);
+        if (opt.random_seed) c.set_random_seed(*opt.random_seed);
+        if (opt.timeout) c.set_timeout(*opt.timeout);
+        if (opt.trace) c.set_trace(true);
+        if (opt.stats) c.set_statistics(true);
+        // Question: is really inHC4 good?
+        c.set_inHC4(true);
+        if (opt.output_no_obj) c.set_extended_cov(false);
+    };
+    apply_settings(config);
+
+    if (!quiet) {
+        if (!config.with_inHC4())
+            cerr << "\n  \033[33mwarning: inHC4 disabled\033[0m (unimplemented operator)" << endl;
+        if (opt.output_no_obj)
+            cout << "  Generates COV with:\tvariable domains only\n";
+        cout << "*******************************************************" << endl << endl;
+    }
+
+    // Build the optimizer (default or FD mode)
+    Optimizer* opt_ptr = NULL;
+    std::vector<std::unique_ptr<OptimLargestFirst>> fd_bisectors;
+    std::unique_ptr<SharedCellBuffer> shared_buffer;
+    std::unique_ptr<Optimizer> opt_owner;
+    std::unique_ptr<TempBuffer> temp_buffer;
+    TempBuffer* temp_raw = nullptr;
+    ShardedTempBuffer* sharded_raw = nullptr;
+
+    // COV de entrada en formato FDA, en modo secuencial base: se lee mapeado
+    // y las celdas se crean a medida que el buffer las necesita. El buffer
+    // perezoso entrega las cajas pendientes en orden de cota inferior; con
+    // las variantes FD (selección térmica) eso cambiaría el orden de
+    // exploración respecto de retomar con todas las celdas, así que ahí el
+    // archivo se carga completo.
+    bool lazy_input = !input_cov.empty() && nb_threads<=1 && !use_fd_variant && is_fda_cov(input_cov);
+    std::unique_ptr<LazyCovBuffer> lazy_buffer;
+
+    // Con threads>1 el buffer elegido se envuelve en uno concurrente,
+    // compartido por todos los workers.
+    auto share = [&](CellBufferOptim& b) -> CellBufferOptim& {
+        if (nb_threads<=1) {
+            if (!lazy_input) return b;
+            lazy_buffer.reset(new LazyCovBuffer(b));
+            return *lazy_buffer;
+        }
+        shared_buffer.reset(new ConcurrentBuffer(b));
+        return *shared_buffer;
+    };
+
+    // Optimizador sobre la configuración `c` y el buffer `buf`.
+    auto make_optimizer = [&](FdConfig& c, CellBufferOptim& buf) -> Optimizer* {
+        if (use_fd_variant) {
+            // Para estas variantes, usamos un bisector OptimLargestFirst sin dividir el objetivo.
+            const Vector& ex = c.get_eps_x();
+            double eps_scalar = ex.size()>=1 ? ex[0] : OptimizerConfig::default_eps_x;
+            fd_bisectors.emplace_back(new OptimLargestFirst(c.get_ext_sys().goal_var(), /*choose_obj=*/false, eps_scalar));
+            Optimizer* o = new Optimizer(
+                c.nb_var(),
+                c.get_ctc(),
+                *fd_bisectors.back(),
+                c.get_loup_finder(),
+                buf,
+                c.goal_var(),
+                OptimizerConfig::default_eps_x,
+                c.get_rel_eps_f(),
+                c.get_abs_eps_f(),
+                c.with_statistics());
+            // Este constructor no lee la configuración: lo que Optimizer(c)
+            // toma de ella (--timeout, --output-no-obj, --trace) se copia aquí.
+            o->timeout = c.get_timeout();
+            o->extended_COV = c.with_extended_cov();
+            o->trace = c.get_trace();
+            return o;
+        }
+        c.buffer_override = &buf;
+        return new Optimizer(c);
+    };
+
+    if (use_fd_variant) {
+        const string& mode = fd_choice;
+        ExtendedSystem& ext_sys = config.get_ext_sys();
+        CellBufferOptim* buffer_ptr = &config.get_cell_buffer();
+        double V0_ref = 1.0;
+        double logV_ref = 0.0;
+        if (!sys->box.is_empty() && !sys->box.is_unbounded()) {
+            try { V0_ref = sys->box.volume(); } catch (...) { V0_ref = 1.0; }
+        }
+        // Calcular log10(volumen) como respaldo si el volumen desborda.
+        logV_ref = Cell::box_log_volume(sys->box);
+        if (!std::isfinite(V0_ref) || V0_ref<=0.0) {
+            V0_ref = 1.0; // evitamos INF/NaN
+        }
+        if (!std::isfinite(logV_ref)) {
+            try { logV_ref = std::log10(std::max(1e-12, V0_ref)); } catch (...) { logV_ref = 0.0; }
+        }
+        bool is_rand = (mode.find("_rand")!=string::npos);
+        bool use_depth = (mode.find("depth")!=string::npos);
+        bool use_vol   = (mode.find("vol")!=string::npos);
+
+        // Semilla base: si no dan random-seed, usamos un valor no determinista.
+        uint64_t seed = opt.random_seed ? static_cast<uint64_t>(*opt.random_seed) : static_cast<uint64_t>(std::random_device{}());
+
+        // Generador de la corrida (no thread_local: un hilo del menú corre
+        // varias y cada una debe partir de su semilla).
+        std::mt19937_64 gen(seed);
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        auto u01 = [&]() { return dist(gen); };
+
+        TempBuffer::Params params;
+        // k muestreado por corrida (±20%) y con ruido de tie-break más alto
+        double k_base = 10.0;
+        double k_spread = is_rand ? 0.3 : 0.2; // más dispersión en rand
+        params.k = k_base * (1.0 + k_spread * (2.0*u01()-1.0));
+        params.k = std::max(5.0, std::min(15.0, params.k));
+        params.bias = 1e-2; // peso térmico moderado (se ajusta más abajo si dominio enorme)
+        params.T0 = 100.0;
+        // Ajustes adaptativos según el volumen inicial: dominios grandes => vol_ratio más alto, depth_cut más bajo.
+        double logV = 0.0;
+        if (V0_ref>0) logV = std::log10(std::max(1e-12, V0_ref));
+        int nv = sys->nb_var;
+        auto scale_vol = [&](double base) {
+            double v = base;
+            // Problemas grandes: permitir explorar más -> bajar umbral
+            if (logV > 6) v *= 0.7;
+            else if (logV > 3) v *= 0.85;
+            else if (logV < -2) v *= 1.3;  // problemas pequeños: disparar antes
+            if (nv > 20) v *= 0.8;         // muchos vars -> bajar umbral
+            if (nv < 8) v *= 1.2;          // pocos vars -> subir umbral
+            return v;
+        };
+        auto scale_depth = [&](int base) {
+            int d = base;
+            // Problemas grandes: permitir más profundidad
+            if (logV > 6) d = d+2;
+            else if (logV > 3) d = d+1;
+            else if (logV < -2) d = std::max(1, d-1); // problemas pequeños: menos profundidad
+            if (nv > 20) d = d+1;                     // más vars -> más profundidad
+            if (nv < 8) d = std::max(1, d-1);         // pocos vars -> menos
+            return d;
+        };
+        // depth cut muestreado por corrida (alrededor de 2-3 para disparar)
+        if (use_depth) {
+            int d = static_cast<int>(std::round(2.5 * (1.0 + 0.1 * (2.0*u01()-1.0))));
+            d = scale_depth(d);
+            params.depth_cut = std::max(2, std::min(6, d));
+            params.depth_cut_jitter = 0.1; // variación por nodo
+            params.depth_hard_cut = 0.0; // cortes duros desactivados
+        } else {
+            params.depth_cut = 0;
+        }
+        // vol cut muestreado por corrida (alrededor de 5%)
+        if (use_vol) {
+            // Umbral medio para que dispare antes: subimos el corte de volumen.
+            double v = 0.22 * (1.0 + 0.1 * (2.0*u01()-1.0));
+            v = scale_vol(v);
+            params.vol_ratio_cut = std::max(0.15, std::min(0.3, v));
+            params.vol_cut_jitter = 0.15; // variación por nodo más alta
+            params.vol_hard_ratio = 0.0; // cortes duros desactivados
+        } else {
+            params.vol_ratio_cut = 0.0;
+        }
+        params.V0_ref = V0_ref;
+        params.log_V0_ref = logV_ref;
+        params.use_log_volume = true; // usar siempre log para evitar overflow/underflow en volumen
+        // Penalizaciones desactivadas: priorizamos sólo temperatura (bias).
+        params.depth_penalty = 0.0;
+        params.vol_penalty = 0.0;
+        params.rand_k = is_rand;
+        params.rand_seed = seed;
+        params.tie_noise = 1e-3; // ruido para desempate moderado
+
+        // Ajustes extra para dominios muy grandes: reducir ruido térmico y profundidades.
+        if (logV > 6) {
+            params.bias *= 0.1;          // menos peso térmico
+            params.tie_noise *= 0.1;     // menos ruido
+            params.vol_hard_ratio = 0.03; // corte duro moderado en volumen relativo
+            if (params.vol_ratio_cut > 0.25) params.vol_ratio_cut = 0.25;
+            if (use_depth) {
+                params.depth_cut = std::max(2, std::min(4, params.depth_cut));
+                params.depth_hard_cut = params.depth_cut + 2;
+            }
+            if (is_rand) {
+                // bajar la dispersión de k en dominios enormes para no ir a rutas muy malas
+                double kspread = 0.15;
+                params.k = k_base * (1.0 + kspread * (2.0*u01()-1.0));
+                params.k = std::max(5.0, std::min(15.0, params.k));
+            }
+        } else if (logV > 3) {
+            params.bias *= 0.3;
+            params.tie_noise *= 0.3;
+            params.vol_hard_ratio = 0.025;
+            if (params.vol_ratio_cut > 0.22) params.vol_ratio_cut = 0.22;
+        }
+
+        if (nb_threads>1 && !opt.shared_temp) {
+            // Un shard de TempBuffer por worker (robo de trabajo entre shards).
+            sharded_raw = new ShardedTempBuffer(ext_sys, ext_sys.goal_var(), params, *buffer_ptr, nb_threads);
+            shared_buffer.reset(sharded_raw);
+        } else {
+            temp_buffer.reset(new TempBuffer(ext_sys, ext_sys.goal_var(), params, *buffer_ptr));
+            temp_raw = temp_buffer.get();
+            buffer_ptr = temp_raw;
+        }
+
+        opt_owner.reset(make_optimizer(config, sharded_raw ? *sharded_raw : share(*buffer_ptr)));
+        opt_ptr = opt_owner.get();
+        if (!quiet) cout << "  fd-mode:\t\t" << mode << " (bisector OptimLargestFirst + TempBuffer)\n";
+    } else if (!fd_choice.empty() && !quiet) {
+        cerr << "  [warning] fd-mode '" << fd_choice << "' no soportado; usando modo base.\n";
+    }
+
+    if (!opt_ptr) {
+        opt_owner.reset(make_optimizer(config, share(config.get_default_cell_buffer())));
+        opt_ptr = opt_owner.get();
+    }
+    Optimizer& o = *opt_ptr;
+
+    // Workers del modo paralelo: cada uno con su propia configuración
+    // (contractor, loup finder y bisector propios) sobre el buffer compartido.
+    std::vector<std::unique_ptr<FdConfig>> worker_configs;
+    std::vector<std::unique_ptr<Optimizer>> worker_owners;
+    std::vector<Optimizer*> workers { opt_ptr };
+    for (int w=1; w<nb_threads; w++) {
+        worker_configs.emplace_back(new FdConfig(*sys));
+        apply_settings(*worker_configs.back());
+        worker_owners.emplace_back(make_optimizer(*worker_configs.back(), *shared_buffer));
+        workers.push_back(worker_owners.back().get());
+    }
+    for (Optimizer* w : workers) {
+        if (opt.async_loup) w->async_loup = true;
+        if (opt.adaptive_loup) w->adaptive_loup = true;
+        if (opt.thread_time) w->thread_cpu_time = true;
+    }
+    if (nb_threads<=1) o.live_cells = opt.live_cells;
+
+    if (!checkpoint_cov.empty()) {
+        if (nb_threads>1) {
+            if (!quiet) cerr << "  [warning] checkpoints no soportados con --threads N>1; se ignoran.\n";
+        } else {
+            o.checkpoint_file = checkpoint_cov;
+            // Las celdas van del buffer al archivo (formato FDA, con sus
+            // metadatos), sin copiar el buffer en memoria.
+            bool compress = opt.cov_compress;
+            o.checkpoint_sink = [&o, compress](const string& file, const CovOptimData& header,
+                                               const CellBufferVisitable& cells) {
+                FdaCovWriter writer(file, o.n, o.goal_var, o.extended_COV, compress);
+                if (compress) writer.set_reference(header.loup_point(), header.uplo(), header.loup());
+                cells.visit([&writer](const Cell& c) { writer.add(c); });
+                writer.finish(header);
+            };
+            if (opt.checkpoint_cells) o.checkpoint_cells = *opt.checkpoint_cells;
+            if (opt.checkpoint_every || !opt.checkpoint_cells)
+                o.checkpoint_period = opt.checkpoint_every ? *opt.checkpoint_every : 60;
+            if (!quiet) {
+                cout << "  checkpoint file:\t" << checkpoint_cov;
+                if (o.checkpoint_period>0) cout << " (every " << o.checkpoint_period << "s)";
+                if (o.checkpoint_cells>0) cout << " (every " << o.checkpoint_cells << " cells)";
+                cout << "\n";
+            }
+        }
+    }
+
+    // COV de entrada en formato FDA sin buffer perezoso: se carga completo,
+    // con los metadatos de las celdas (un COV de Ibex lo carga el propio
+    // Optimizer).
+    std::unique_ptr<CovOptimData> input_data;
+    std::vector<Optimizer::CellMeta> input_meta;
+    if (!input_cov.empty() && !lazy_input && is_fda_cov(input_cov))
+        input_data.reset(load_fda_cov(input_cov, input_meta));
+
+    // --cov-stream: las celdas restantes van directo del buffer al archivo.
+    // Si el COV de salida es el mismo de entrada, se escribe con otro nombre
+    // y se renombra al final: con el buffer perezoso el archivo de entrada
+    // sigue mapeado, con cajas pendientes, mientras se vacía el buffer.
+    bool stream = opt.save_cov && (opt.cov_stream || opt.cov_compress);
+    string stream_file = output_cov_file;
+    if (stream && !input_cov.empty()) {
+        std::error_code ec;
+        if (std::filesystem::equivalent(input_cov, output_cov_file, ec))
+            stream_file = output_cov_file + ".tmp";
+    }
+    std::unique_ptr<FdaCovWriter> cov_writer;
+    auto open_cov_writer = [&]() {
+        if (cov_writer) return;
+        cov_writer.reset(new FdaCovWriter(stream_file, o.n, o.goal_var, o.extended_COV, opt.cov_compress));
+        // Se abre en Optimizer::save_cov: loup y loup-point ya son los finales.
+        if (opt.cov_compress) cov_writer->set_reference(o.get_loup_point(), o.get_uplo(), o.get_loup());
+    };
+    if (stream) {
+        o.cov_sink = [&](const Cell& c) {
+            open_cov_writer();
+            cov_writer->add(c);
+        };
+    } else if (!opt.save_cov) {
+        o.cov_sink = [](const Cell&) {}; // se descartan sin copiarlas
+    }
+
+    if (!quiet) {
+        // display solutions with up to 12 decimals
+        cout.precision(12);
+        cout << "running............" << endl << endl;
+    }
+
+    double obj_init_bound = opt.initial_loup ? *opt.initial_loup : POS_INFINITY;
+
+    // Search for the optimum
+    unlocked(lock, [&]() {
+        if (nb_threads>1) {
+            ParallelOptimizer par(workers, *shared_buffer, opt.timeout ? *opt.timeout : -1);
+            if (input_data)
+                par.optimize(*input_data, obj_init_bound, &input_meta);
+            else if (!input_cov.empty())
+                par.optimize(input_cov.c_str(), obj_init_bound);
+            else
+                par.optimize(sys->box, obj_init_bound);
+        }
+        else if (input_data) {
+            o.start(*input_data, obj_init_bound, &input_meta);
+            o.optimize();
+        }
+        else if (lazy_input) {
+            std::shared_ptr<const FdaCovMap> map(new FdaCovMap(input_cov));
+            std::unique_ptr<CovOptimData> header(map->header_data());
+            o.start(*header, obj_init_bound);
+            bool extended = map->extended();
+            lazy_buffer->attach(map, [&o, extended](const IntervalVector& box, const Optimizer::CellMeta& m) {
+                return o.make_cov_cell(box, extended, &m);
+            });
+            o.optimize();
+        }
+        else if (!input_cov.empty())
+            o.optimize(input_cov.c_str(), obj_init_bound);
+        else
+            o.optimize(sys->box, obj_init_bound);
+    });
+
+    if (!quiet) {
+        cout << "nodes (cells):\t\t" << o.get_nb_cells() << endl;
+        if (opt.trace) cout << endl;
+        // Report some information (computation time, etc.)
+        o.report(); // will include statistics if they are enabled
+    }
+
+    res.status = o.get_status();
+    res.loup = o.get_loup();
+    res.uplo = o.get_uplo();
+    res.time = o.get_time();
+    res.nb_cells = o.get_nb_cells();
+
+    if (temp_raw || sharded_raw) {
+        // Sumados sobre los shards.
+        res.fd_stats = true;
+        res.triggers = sharded_raw ? sharded_raw->stats() : temp_raw->stats();
+        res.sharded = (sharded_raw != nullptr);
+        if (sharded_raw) res.steals = sharded_raw->steal_count();
+    }
+    for (Optimizer* w : workers) {
+        res.loup_calls_skipped += w->get_loup_calls_skipped();
+        res.loup_boxes_dropped += w->get_loup_boxes_dropped();
+    }
+
+    if (stream) {
+        open_cov_writer(); // sin celdas restantes no se abrió
+        cov_writer->finish(o.get_data());
+        if (stream_file != output_cov_file && rename(stream_file.c_str(), output_cov_file.c_str()) != 0) {
+            res.error = "cannot rename " + stream_file + " to " + output_cov_file;
+            return;
+        }
+    } else if (opt.save_cov) {
+        o.get_data().save(output_cov_file.c_str());
+        // Profundidad/temperatura de las celdas, para retomar con el mismo orden.
+        if (use_fd_variant)
+            Optimizer::save_cell_meta(output_cov_file, o.get_cell_meta());
+    }
+
+    if (opt.save_cov) {
+        res.output_cov_file = output_cov_file;
+        if (!quiet) {
+            cout << " results written in " << output_cov_file << "\n";
+            if (overwitten)
+                cout << " (old file saved in " << cov_copy << ")\n";
+        }
+    }
+
+    res.ok = true;
+}
+
+} // namespace
+
+SystemCache::~SystemCache() {
+    clear();
+}
+
+System* SystemCache::copy(const std::string& filename, int simpl_level) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::unique_ptr<System>& sys = systems_[std::make_pair(filename, simpl_level)];
+    if (!sys) {
+        try {
+            sys.reset(new System(filename.c_str(), simpl_level));
+        } catch (...) {
+            systems_.erase(std::make_pair(filename, simpl_level));
+            throw;
+        }
+    }
+    return new System(*sys, System::COPY);
+}
+
+void SystemCache::release(const std::string& filename) {
+    // Los System se destruyen con el lock de la capa simbólica.
+    std::lock_guard<std::mutex> setup(setup_mutex);
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto it = systems_.begin(); it != systems_.end();) {
+        if (it->first.first == filename) it = systems_.erase(it);
+        else ++it;
+    }
+}
+
+void SystemCache::clear() {
+    std::lock_guard<std::mutex> setup(setup_mutex);
+    std::lock_guard<std::mutex> guard(mutex_);
+    systems_.clear();
+}
+
+size_t SystemCache::size() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return systems_.size();
+}
+
+FdaRunResult run_fda(const FdaRunOptions& opt) {
+    FdaRunResult res;
+    // Tomado antes de crear la corrida y liberado después de destruirla.
+    std::unique_lock<std::mutex> lock(setup_mutex);
+    try {
+        int simpl_level = opt.simpl_level ? *opt.simpl_level : ExprNode::default_simpl_level;
+        // Load a system of equations
+        std::unique_ptr<System> sys(opt.cache ? opt.cache->copy(opt.filename, simpl_level)
+                                              : new System(opt.filename.c_str(), simpl_level));
+        run(opt, sys.get(), lock, res);
+    }
+    catch (ibex::UnknownFileException&) {
+        res.error = "cannot read file '" + opt.filename + "'";
+    }
+    catch (ibex::SyntaxError& e) {
+        stringstream ss;
+        ss << e;
+        res.error = ss.str();
+    }
+    catch (ibex::Exception&) {
+        res.error = "ibex exception while solving " + opt.filename;
+    }
+    catch (std::exception& e) {
+        res.error = e.what();
+    }
+    if (!res.ok && res.error.empty()) res.error = "run failed";
+    return res;
+}
@@ -0,0 +1,139 @@
+// fda_runner.h
+// Una corrida completa de ibex_opt_full como función: lee el .bch, arma la
+// configuración (modo base o variante FDA), busca el óptimo y escribe el COV.
+// La usan el ejecutable ibex_opt_full (main sólo traduce los argumentos) y
+// ibex_menu, que corre varias a la vez en el mismo proceso, una por hilo.
+
+#pragma once
+
+#include "ibex.h"
+#include "temp_buffer.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+struct FdaRunOptions;
+struct FdaRunResult;
+
+// El generador aleatorio de Ibex (RNG) es global al proceso y no es seguro
+// entre hilos: lo usan el linearizador (esquinas aleatorias de XTaylor) y el
+// loup finder. Sólo con una build de Ibex que lo guarde por hilo (definir
+// FDA_THREAD_LOCAL_RNG, ver CMakeLists.txt) se permiten búsquedas con varios
+// hilos (--threads N>1, --async-loup) o varias corridas a la vez en un mismo
+// proceso (ibex_menu sin --isolate).
+#ifdef FDA_THREAD_LOCAL_RNG
+constexpr bool fda_threaded_search = true;
+#else
+constexpr bool fda_threaded_search = false;
+#endif
+
+// Sistemas ya leídos, para las corridas repetidas de un mismo problema: el
+// .bch se lee y se simplifica una sola vez y cada corrida recibe una copia
+// (System::COPY, sin volver a pasar por el parser). La configuración
+// (sistema extendido y normalizado, contractores, loup finder) se sigue
+// armando por corrida: sus Function guardan datos de evaluación y no se
+// pueden compartir entre hilos.
+class SystemCache {
+public:
+    ~SystemCache();
+
+    // Olvida los sistemas de este archivo (todos los niveles de simplificación).
+    void release(const std::string& filename);
+    void clear();
+
+    size_t size() const;
+
+private:
+    friend FdaRunResult run_fda(const FdaRunOptions& opt);
+
+    mutable std::mutex mutex_;
+    std::map<std::pair<std::string, int>, std::unique_ptr<ibex::System>> systems_;
+
+    // Copia nueva del sistema (lo lee la primera vez). Sólo desde run_fda,
+    // que ya tiene tomado el lock de la capa simbólica de Ibex.
+    ibex::System* copy(const std::string& filename, int simpl_level);
+};
+
+// Opciones de la corrida: las mismas de la línea de comandos de
+// ibex_opt_full (un campo vacío equivale a no pasar la opción).
+struct FdaRunOptions {
+    std::string filename;       // archivo Minibex
+    std::string fd_mode;        // "", depth_k, depth_k_rand, vol_k, vol_k_rand
+
+    std::optional<double> rel_eps_f;
+    std::optional<double> abs_eps_f;
+    std::optional<double> eps_h;
+    std::optional<double> eps_x;
+    std::optional<double> timeout;
+    std::optional<double> random_seed;
+    std::optional<double> initial_loup;
+    std::optional<int>    simpl_level;
+    std::string no_split;
+
+    bool rigor = false;
+    bool kkt = false;
+    bool output_no_obj = false;
+    bool trace = false;
+    bool stats = false;
+    bool quiet = false;
+
+    int  threads = 1;
+    bool shared_temp = false;
+    bool async_loup = false;
+    bool adaptive_loup = false;
+
+    std::string input_file;
+    std::string output_file;
+    std::string resume;
+    std::string checkpoint;
+    std::optional<double> checkpoint_every;
+    std::optional<int>    checkpoint_cells;
+    bool cov_stream = false;
+    bool cov_compress = false;
+
+    // false: no se escribe el COV de salida (las celdas restantes se
+    // descartan al final); es lo que usa el menú, que sólo lee el resultado.
+    bool save_cov = true;
+    // Tiempo y timeout en CPU del hilo de la corrida y no del proceso (ver
+    // Optimizer::thread_cpu_time): necesario con varias corridas a la vez.
+    bool thread_time = false;
+    // Si no es nulo, el sistema se copia de este cache (y se agrega si falta).
+    SystemCache* cache = nullptr;
+    // Si no es nulo, la búsqueda secuencial publica aquí el número de celdas
+    // de su buffer (ver Optimizer::live_cells).
+    std::atomic<unsigned int>* live_cells = nullptr;
+};
+
+struct FdaRunResult {
+    bool ok = false;
+    std::string error;          // mensaje si !ok
+
+    ibex::Optimizer::Status status = ibex::Optimizer::SUCCESS;
+    double loup = ibex::POS_INFINITY;
+    double uplo = ibex::NEG_INFINITY;
+    double time = 0;            // cpu time used (de reloj con threads>1)
+    int nb_cells = 0;
+    std::string output_cov_file; // vacío si !save_cov
+
+    // Contadores de la variante FDA (sumados sobre los shards / workers).
+    bool fd_stats = false;
+    TempBuffer::Stats triggers;
+    size_t steals = 0;
+    bool sharded = false;
+    int loup_calls_skipped = 0;
+    int loup_boxes_dropped = 0;
+};
+
+// Ejecuta la corrida. No termina el proceso ante errores de lectura o de
+// configuración: los devuelve en FdaRunResult::error. Con opt.quiet no
+// escribe nada en la salida estándar. Se puede llamar desde varios hilos a
+// la vez: la lectura del sistema y la construcción de la configuración (que
+// pasan por el parser y la capa simbólica de Ibex, no reentrantes) se
+// serializan; la búsqueda corre en paralelo. Varias llamadas a la vez sólo
+// con fda_threaded_search (RNG de Ibex por hilo).
+FdaRunResult run_fda(const FdaRunOptions& opt);
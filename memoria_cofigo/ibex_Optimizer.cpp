@@ -13,15 +13,203 @@
 #include "ibex_NoBisectableVariableException.h"
 #include "ibex_BxpOptimData.h"
 #include "ibex_CovOptimData.h"
+#include "ibex_LogVolume.h"
 
 #include <float.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <iomanip>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <time.h>
 
 using namespace std;
 
 namespace ibex {
 
+namespace {
+
+// Bands of the adaptive loup finder policy (see Optimizer::adaptive_loup):
+// depth by steps of LOUP_DEPTH_STEP, log10 of the temperature by steps of
+// LOUP_TEMP_STEP decades (the last band of each also takes what is above).
+const int LOUP_DEPTH_BANDS=16;
+const int LOUP_DEPTH_STEP=4;
+const int LOUP_TEMP_BANDS=8;
+const int LOUP_TEMP_STEP=2;
+
+// A band is throttled after LOUP_MIN_CALLS calls with a success rate
+// below LOUP_MIN_RATE: the loup finder is then called on one cell out of
+// LOUP_THROTTLE.
+const int LOUP_MIN_CALLS=32;
+const double LOUP_MIN_RATE=0.02;
+const int LOUP_THROTTLE=8;
+
+// Side file of the COV with the cell metadata (see Optimizer::save_cell_meta):
+// magic, version, number of boxes, checksum of the COV file and one record
+// per box.
+const char CELL_META_MAGIC[4]={'F','D','A','M'};
+const uint32_t CELL_META_VERSION=2;
+
+// FNV-1a hash of the whole file (0 if it cannot be read): ties a side file
+// to the exact COV file it was written for.
+uint64_t file_checksum(const string& filename) {
+	ifstream is(filename.c_str(), ios::binary);
+	if (!is) return 0;
+	uint64_t h=0xcbf29ce484222325ULL;
+	char chunk[1<<16];
+	while (is) {
+		is.read(chunk, sizeof(chunk));
+		for (streamsize i=0; i<is.gcount(); i++) {
+			h^=(unsigned char) chunk[i];
+			h*=0x100000001b3ULL;
+		}
+	}
+	return h;
+}
+
+Optimizer::CellMeta cell_meta(const Cell& c) {
+	Optimizer::CellMeta m;
+	m.depth=c.depth;
+	m.bisected_var=c.bisected_var;
+	m.temperature=c.temperature;
+	m.log_volume=c.has_log_volume() ? c.get_log_volume() : POS_INFINITY;
+	return m;
+}
+
+// entry of the loup-point (not a cell)
+Optimizer::CellMeta loup_point_meta() {
+	Optimizer::CellMeta m;
+	m.depth=0;
+	m.bisected_var=-1;
+	m.temperature=Cell::temp_T0_;
+	m.log_volume=POS_INFINITY;
+	return m;
+}
+
+// CPU time of the calling thread (see Optimizer::thread_cpu_time)
+double thread_cpu_seconds() {
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec+1e-9*ts.tv_nsec;
+}
+
+}
+
+/*
+ * Loup finder running in its own thread (see Optimizer::async_loup).
+ *
+ * The thread is the only user of the loup finder while it runs. Boxes
+ * are processed in FIFO order; the best loup found so far (or given by
+ * the optimizer with submit) is the bound passed to the loup finder.
+ */
+class Optimizer::AsyncLoupFinder {
+public:
+	AsyncLoupFinder(LoupFinder& finder, double loup, const IntervalVector& loup_point) :
+		finder(finder), loup(loup), loup_point(loup_point), busy(false), stop(false), dropped(0),
+		thread(&AsyncLoupFinder::run, this) { }
+
+	~AsyncLoupFinder() {
+		{
+			lock_guard<mutex> lock(m);
+			stop=true;
+		}
+		cv.notify_all();
+		thread.join();
+	}
+
+	// queue a box; the optimizer's loup may be better than ours
+	// (imported from another optimizer)
+	void submit(const IntervalVector& box, double opt_loup, const IntervalVector& opt_loup_point) {
+		{
+			lock_guard<mutex> lock(m);
+			if (opt_loup<loup) {
+				loup=opt_loup;
+				loup_point=opt_loup_point;
+			}
+			if (queue.size()>=max_queue) {
+				queue.pop_front();
+				dropped++;
+			}
+			queue.push_back(box);
+		}
+		cv.notify_one();
+	}
+
+	// true (and the loup found) if better than opt_loup
+	bool get_loup(double& opt_loup, IntervalVector& opt_loup_point) {
+		lock_guard<mutex> lock(m);
+		if (loup>=opt_loup) return false;
+		opt_loup=loup;
+		opt_loup_point=loup_point;
+		return true;
+	}
+
+	// wait until all the queued boxes are processed
+	void wait() {
+		unique_lock<mutex> lock(m);
+		idle.wait(lock, [this] { return queue.empty() && !busy; });
+	}
+
+	int nb_dropped() {
+		lock_guard<mutex> lock(m);
+		return dropped;
+	}
+
+private:
+	static const size_t max_queue=16;
+
+	void run() {
+		unique_lock<mutex> lock(m);
+		while (true) {
+			cv.wait(lock, [this] { return stop || !queue.empty(); });
+			if (stop) break;
+
+			IntervalVector box=queue.front();
+			queue.pop_front();
+			busy=true;
+			double bound=loup;
+			IntervalVector point=loup_point;
+			lock.unlock();
+
+			// properties of the loup finder only (the cell ones belong to the optimizer thread)
+			BoxProperties prop(box);
+			finder.add_property(box, prop);
+			bool found=false;
+			pair<IntervalVector,double> p(point, bound);
+			try {
+				p=finder.find(box, point, bound, prop);
+				found=true;
+			} catch(LoupFinder::NotFound&) { }
+
+			lock.lock();
+			if (found && p.second<loup) {
+				loup=p.second;
+				loup_point=p.first;
+			}
+			busy=false;
+			if (queue.empty()) idle.notify_all();
+		}
+	}
+
+	LoupFinder& finder;
+	mutex m;
+	condition_variable cv;
+	condition_variable idle;
+	deque<IntervalVector> queue;
+	double loup;
+	IntervalVector loup_point;
+	bool busy;
+	bool stop;
+	int dropped;
+	std::thread thread;
+};
+
 /*
  * TODO: redundant with ExtendedSystem.
  */
@@ -48,11 +236,15 @@ Optimizer::Optimizer(int n, Ctc& ctc, Bsc& bsc, LoupFinder& finder,
                 						n(n), goal_var(goal_var),
 										ctc(ctc), bsc(bsc), loup_finder(finder), buffer(buffer),
 										eps_x(n, eps_x), rel_eps_f(rel_eps_f), abs_eps_f(abs_eps_f),
-										trace(0), timeout(-1), extended_COV(true), anticipated_upper_bounding(true),
+										trace(0), timeout(-1), extended_COV(true), anticipated_upper_bounding(true), async_loup(false), adaptive_loup(false),
+										checkpoint_period(-1), checkpoint_cells(-1), thread_cpu_time(false), live_cells(NULL),
 										status(SUCCESS),
 										uplo(NEG_INFINITY), uplo_of_epsboxes(POS_INFINITY), loup(POS_INFINITY),
 										loup_point(IntervalVector::empty(n)), initial_loup(POS_INFINITY), loup_changed(false),
-										time(0), nb_cells(0), cov(NULL) {
+										time(0), nb_cells(0), cov(NULL), x_box(n),
+										async_finder(NULL), loup_boxes_dropped(0),
+										loup_bands(LOUP_DEPTH_BANDS*LOUP_TEMP_BANDS), loup_calls_skipped(0),
+										bsc_skips_goal(false), last_checkpoint_time(0), last_checkpoint_cells(0) {
 
 	if (trace) cout.precision(12);
 	
@@ -87,6 +279,7 @@ Optimizer::Optimizer(OptimizerConfig& config) :
 }
 
 Optimizer::~Optimizer() {
+	stop_loup_finder();
 	if (cov) delete cov;
 	if (statistics) delete statistics;
 }
@@ -111,6 +304,13 @@ double Optimizer::compute_ymax() {
 
 bool Optimizer::update_loup(const IntervalVector& box, BoxProperties& prop) {
 
+	if (async_loup) {
+		if (!async_finder)
+			async_finder=new AsyncLoupFinder(loup_finder, loup, loup_point);
+		async_finder->submit(box, loup, loup_point);
+		return adopt_async_loup();
+	}
+
 	try {
 
 		pair<IntervalVector,double> p=loup_finder.find(box,loup_point,loup,prop);
@@ -133,6 +333,75 @@ bool Optimizer::update_loup(const IntervalVector& box, BoxProperties& prop) {
 	}
 }
 
+bool Optimizer::adopt_async_loup() {
+	if (!async_finder || !async_finder->get_loup(loup, loup_point))
+		return false;
+
+	if (trace) {
+		cout << "                    ";
+		cout << "\033[32m loup= " << loup << "\033[0m (async)" << endl;
+	}
+	return true;
+}
+
+bool Optimizer::sync_loup_finder() {
+	if (!async_finder) return false;
+	async_finder->wait();
+	bool loup_ch=adopt_async_loup();
+	stop_loup_finder();
+	return loup_ch;
+}
+
+void Optimizer::stop_loup_finder() {
+	if (!async_finder) return;
+	loup_boxes_dropped += async_finder->nb_dropped();
+	delete async_finder;
+	async_finder=NULL;
+}
+
+Optimizer::LoupBand& Optimizer::loup_band(const Cell& c) {
+	int d=std::min((int) c.depth/LOUP_DEPTH_STEP, LOUP_DEPTH_BANDS-1);
+	int t=LOUP_TEMP_BANDS-1;
+	if (std::isfinite(c.temperature))
+		t=c.temperature<=1 ? 0 : std::min((int) (std::log10(c.temperature)/LOUP_TEMP_STEP), LOUP_TEMP_BANDS-1);
+	return loup_bands[d*LOUP_TEMP_BANDS+t];
+}
+
+bool Optimizer::skip_loup_finder(const Cell& c) {
+	if (!adaptive_loup || async_loup || loup==POS_INFINITY) return false;
+
+	LoupBand& b=loup_band(c);
+	if (b.calls<LOUP_MIN_CALLS || b.hits>=LOUP_MIN_RATE*b.calls) return false;
+
+	if (++b.skipped<LOUP_THROTTLE) {
+		loup_calls_skipped++;
+		return true;
+	}
+	b.skipped=0;
+	return false;
+}
+
+optional<BisectionPoint> Optimizer::choose_bisection(const Cell& c) {
+
+	// Widths are checked first: the bisector refuses a box whose variables
+	// are all too small, and catching its exception is much slower.
+	bool goal_only=true;
+	for (int i=0; i<n+1 && goal_only; i++)
+		if (i!=goal_var && !bsc.too_small(c.box,i)) goal_only=false;
+
+	if (goal_only && (bsc_skips_goal || bsc.too_small(c.box,goal_var)))
+		return nullopt;
+
+	try {
+		return bsc.choose_var(c);
+	} catch (NoBisectableVariableException&) {
+		// the bisector does not split the objective alone (e.g., OptimLargestFirst
+		// without choose_obj): next time, no need to ask it
+		if (goal_only) bsc_skips_goal=true;
+		return nullopt;
+	}
+}
+
 //bool Optimizer::update_entailed_ctr(const IntervalVector& box) {
 //	for (int j=0; j<m; j++) {
 //		if (entailed->normalized(j)) {
@@ -223,6 +492,10 @@ void Optimizer::contract_and_bound(Cell& c) {
 	// TODO: useful with double heap??
 	else ymax = compute_ymax()+1.e-15;
 
+	// FDA: the cached log-volume (if any) is refreshed only on the coordinates that change
+	bool track_log_volume=c.has_log_volume();
+	double y_diam=y.diam();
+
 	y &= Interval(NEG_INFINITY,ymax);
 
 	if (y.is_empty()) {
@@ -230,6 +503,7 @@ void Optimizer::contract_and_bound(Cell& c) {
 		return;
 	} else {
 		c.prop.update(BoxEvent(c.box,BoxEvent::CONTRACT,BitSet::singleton(n+1,goal_var)));
+		if (track_log_volume) c.update_log_volume(goal_var,y_diam);
 	}
 
 	/*================ contract x with f(x)=y and g(x)<=0 ================*/
@@ -243,27 +517,55 @@ void Optimizer::contract_and_bound(Cell& c) {
 		context.impact.add(goal_var);
 	}
 
+	if (track_log_volume) {
+		diam_before.resize(n+1);
+		diam_after.resize(n+1);
+		box_diams(c.box,diam_before.data());
+	}
+
 	ctc.contract(c.box, context);
 	//cout << c.prop << endl;
 	if (c.box.is_empty()) return;
 
+	if (track_log_volume) {
+		box_diams(c.box,diam_after.data());
+		int changed=0;
+		for (int i=0; i<n+1; i++)
+			if (diam_after[i]!=diam_before[i]) changed++;
+		// when most coordinates shrank, one vectorized pass beats many scalar updates
+		if (4*changed>n+1)
+			c.reset_log_volume();
+		else
+			for (int i=0; i<n+1; i++)
+				if (diam_after[i]!=diam_before[i]) c.update_log_volume(i,diam_before[i]);
+	}
+
 	//cout << " [contract]  x after=" << c.box << endl;
 	//cout << " [contract]  y after=" << y << endl;
 	/*====================================================================*/
 
 	/*========================= update loup =============================*/
 
-	IntervalVector tmp_box(n);
-	read_ext_box(c.box,tmp_box);
+	read_ext_box(c.box,x_box);
 
 	c.prop.update(BoxEvent(c.box,BoxEvent::CHANGE));
 
-	bool loup_ch=update_loup(tmp_box, c.prop);
+	bool loup_ch=false;
+	if (!skip_loup_finder(c)) {
+		loup_ch=update_loup(x_box, c.prop);
+		if (adaptive_loup && !async_loup) {
+			LoupBand& b=loup_band(c);
+			b.calls++;
+			if (loup_ch) b.hits++;
+		}
+	}
 
 	// update of the upper bound of y in case of a new loup found
 	if (loup_ch) {
+		y_diam=y.diam();
 		y &= Interval(NEG_INFINITY,compute_ymax());
 		c.prop.update(BoxEvent(c.box,BoxEvent::CONTRACT,BitSet::singleton(n+1,goal_var)));
+		if (track_log_volume && !y.is_empty()) c.update_log_volume(goal_var,y_diam);
 	}
 
 	//TODO: should we propagate constraints again?
@@ -282,21 +584,19 @@ void Optimizer::contract_and_bound(Cell& c) {
 	// - the width of the box is less than the precision given to the optimizer ("eps_x" for
 	//   the original variables and "abs_eps_f" for the goal variable)
 	// - the extended box has no bisectable domains (if eps_x=0 or <1 ulp)
-	if (((tmp_box.diam()-eps_x).max()<=0 && y.diam() <=abs_eps_f) || !c.box.is_bisectable()) {
+	bool eps_box=y.diam() <=abs_eps_f;
+	for (int i=0; eps_box && i<n; i++)
+		eps_box = x_box[i].diam() <= eps_x[i];
+
+	if (eps_box || !c.box.is_bisectable()) {
 		update_uplo_of_epsboxes(y.lb());
 		c.box.set_empty();
 		return;
 	}
 
 	// ** important: ** must be done after upper-bounding
-	//kkt.contract(tmp_box);
-
-	if (tmp_box.is_empty()) {
-		c.box.set_empty();
-	} else {
-		// the current extended box in the cell is updated
-		write_ext_box(tmp_box,c.box);
-	}
+	// (x_box would then have to be written back with write_ext_box)
+	//kkt.contract(x_box);
 }
 
 Optimizer::Status Optimizer::optimize(const IntervalVector& init_box, double obj_init_bound) {
@@ -312,12 +612,20 @@ Optimizer::Status Optimizer::optimize(const CovOptimData& data, double obj_init_
 
 Optimizer::Status Optimizer::optimize(const char* cov_file, double obj_init_bound) {
 	CovOptimData data(cov_file);
-	start(data, obj_init_bound);
+	vector<CellMeta> meta;
+	load_cell_meta(cov_file, data.size(), meta);
+	start(data, obj_init_bound, meta.empty() ? NULL : &meta);
 	return optimize();
 }
 
 void Optimizer::start(const IntervalVector& init_box, double obj_init_bound) {
 
+	stop_loup_finder(); // from a previous run
+	std::fill(loup_bands.begin(), loup_bands.end(), LoupBand());
+	loup_calls_skipped=0;
+	last_checkpoint_time=0;
+	last_checkpoint_cells=0;
+
 	loup=obj_init_bound;
 
 	// Just to initialize the "loup" for the buffer
@@ -345,7 +653,9 @@ void Optimizer::start(const IntervalVector& init_box, double obj_init_bound) {
 	buffer.add_property(init_box, root->prop);
 
 	// add data required by the loup finder
-	loup_finder.add_property(init_box, root->prop);
+	// (in async mode, added by the loup finder thread to its own boxes)
+	if (!async_loup)
+		loup_finder.add_property(init_box, root->prop);
 
 	//cout << "**** Properties ****\n" << root->prop << endl;
 
@@ -363,7 +673,13 @@ void Optimizer::start(const IntervalVector& init_box, double obj_init_bound) {
 	handle_cell(*root);
 }
 
-void Optimizer::start(const CovOptimData& data, double obj_init_bound) {
+void Optimizer::start(const CovOptimData& data, double obj_init_bound, const vector<CellMeta>* meta) {
+
+	stop_loup_finder(); // from a previous run
+	std::fill(loup_bands.begin(), loup_bands.end(), LoupBand());
+	loup_calls_skipped=0;
+	last_checkpoint_time=0;
+	last_checkpoint_cells=0;
 
 	loup=obj_init_bound;
 
@@ -374,56 +690,75 @@ void Optimizer::start(const CovOptimData& data, double obj_init_bound) {
 	uplo=data.uplo();
 	loup=data.loup();
 	loup_point=data.loup_point();
-	uplo_of_epsboxes=POS_INFINITY;
+	// epsilon-boxes discarded before the COV was saved (e.g., a checkpoint)
+	// still bound the uplo
+	uplo_of_epsboxes=data.uplo_of_epsboxes();
 
 	nb_cells=0;
 
 	buffer.flush();
 
 	for (size_t i=loup_point.is_empty()? 0 : 1; i<data.size(); i++) {
+		Cell* cell=make_cov_cell(data[i], data.is_extended_space(), meta ? &(*meta)[i] : NULL);
+		if (cell) buffer.push(cell);
+	}
 
-		IntervalVector box(n+1);
+	loup_changed=false;
+	initial_loup=obj_init_bound;
 
-		if (data.is_extended_space())
-			box = data[i];
-		else {
-			write_ext_box(data[i], box);
-			box[goal_var] = Interval(uplo,loup);
-			ctc.contract(box);
-			if (box.is_empty()) continue;
-		}
+	time=0;
 
-		Cell* cell=new Cell(box);
+	if (cov) delete cov;
+	cov = new CovOptimData(extended_COV? n+1 : n, extended_COV);
+	cov->data->_optim_time = data.time();
+	cov->data->_optim_nb_cells = data.nb_cells();
+}
 
-		// add data required by the cell buffer
-		buffer.add_property(box, cell->prop);
+Cell* Optimizer::make_cov_cell(const IntervalVector& cov_box, bool extended, const CellMeta* meta) {
 
-		// add data required by the bisector
-		bsc.add_property(box, cell->prop);
+	IntervalVector box(n+1);
 
-		// add data required by the contractor
-		ctc.add_property(box, cell->prop);
+	if (extended)
+		box = cov_box;
+	else {
+		write_ext_box(cov_box, box);
+		box[goal_var] = Interval(uplo,loup);
+		ctc.contract(box);
+		if (box.is_empty()) return NULL;
+	}
 
-		// add data required by the loup finder
-		loup_finder.add_property(box, cell->prop);
+	Cell* cell=new Cell(box);
 
-		buffer.push(cell);
+	if (meta) {
+		// same depth/temperature as when saved (read by the buffer on push)
+		cell->depth=meta->depth;
+		cell->bisected_var=meta->bisected_var;
+		cell->temperature=meta->temperature;
+		// the box of a non-extended COV has just been contracted
+		if (extended)
+			cell->restore_log_volume(meta->log_volume);
 	}
 
-	loup_changed=false;
-	initial_loup=obj_init_bound;
+	// add data required by the cell buffer
+	buffer.add_property(box, cell->prop);
 
-	time=0;
+	// add data required by the bisector
+	bsc.add_property(box, cell->prop);
 
-	if (cov) delete cov;
-	cov = new CovOptimData(extended_COV? n+1 : n, extended_COV);
-	cov->data->_optim_time = data.time();
-	cov->data->_optim_nb_cells = data.nb_cells();
+	// add data required by the contractor
+	ctc.add_property(box, cell->prop);
+
+	// add data required by the loup finder
+	if (!async_loup)
+		loup_finder.add_property(box, cell->prop);
+
+	return cell;
 }
 
 Optimizer::Status Optimizer::optimize() {
 	Timer timer;
 	timer.start();
+	double thread_start=thread_cpu_time ? thread_cpu_seconds() : 0;
 
 	update_uplo();
 
@@ -435,78 +770,107 @@ Optimizer::Status Optimizer::optimize() {
 			Cell *c = buffer.top();
 			if (trace >= 2) cout << " current box " << c->box << endl;
 
-			try {
+			optional<BisectionPoint> pt=choose_bisection(*c);
 
-				pair<Cell*,Cell*> new_cells=bsc.bisect(*c);
+			if (!pt) { // epsilon-box for the bisector
+				update_uplo_of_epsboxes((c->box)[goal_var].lb());
 				buffer.pop();
 				delete c; // deletes the cell.
+				update_uplo(); // the heap has changed -> recalculate the uplo (eg: if not in best-first search)
+				continue;
+			}
 
-				nb_cells+=2;  // counting the cells handled ( in previous versions nb_cells was the number of cells put into the buffer after being handled)
+			// c is bisected in place: it becomes the left cell
+			// (the buffer is popped before its box is modified)
+			buffer.pop();
+			Cell* right=c->bisect_in_place(*pt);
 
-				handle_cell(*new_cells.first);
-				handle_cell(*new_cells.second);
+			nb_cells+=2;  // counting the cells handled ( in previous versions nb_cells was the number of cells put into the buffer after being handled)
 
-				if (uplo_of_epsboxes == NEG_INFINITY) {
-					break;
-				}
-				if (loup_changed) {
-					// In case of a new upper bound (loup_changed == true), all the boxes
-					// with a lower bound greater than (loup - goal_prec) are removed and deleted.
-					// Note: if contraction was before bisection, we could have the problem
-					// that the current cell is removed by contractHeap. See comments in
-					// older version of the code (before revision 284).
+			handle_cell(*c);
+			handle_cell(*right);
+
+			if (uplo_of_epsboxes == NEG_INFINITY) {
+				break;
+			}
+			if (loup_changed) {
+				// In case of a new upper bound (loup_changed == true), all the boxes
+				// with a lower bound greater than (loup - goal_prec) are removed and deleted.
+				// Note: if contraction was before bisection, we could have the problem
+				// that the current cell is removed by contractHeap. See comments in
+				// older version of the code (before revision 284).
 
-					double ymax=compute_ymax();
+				double ymax=compute_ymax();
 
-					buffer.contract(ymax);
+				buffer.contract(ymax);
 
-					//cout << " now buffer is contracted and min=" << buffer.minimum() << endl;
+				//cout << " now buffer is contracted and min=" << buffer.minimum() << endl;
 
-					// TODO: check if happens. What is the return code in this case?
-					if (ymax <= NEG_INFINITY) {
-						if (trace) cout << " infinite value for the minimum " << endl;
-						break;
-					}
+				// TODO: check if happens. What is the return code in this case?
+				if (ymax <= NEG_INFINITY) {
+					if (trace) cout << " infinite value for the minimum " << endl;
+					break;
 				}
-				update_uplo();
+			}
+			update_uplo();
+
+			if (live_cells) live_cells->store(buffer.size(), std::memory_order_relaxed);
 
-				if (!anticipated_upper_bounding) // useless to check precision on objective if 'true'
-					if (get_obj_rel_prec()<rel_eps_f || get_obj_abs_prec()<abs_eps_f)
-						break;
+			if (!anticipated_upper_bounding) // useless to check precision on objective if 'true'
+				if (get_obj_rel_prec()<rel_eps_f || get_obj_abs_prec()<abs_eps_f)
+					break;
 
+			if (thread_cpu_time) {
+				time = thread_cpu_seconds()-thread_start;
+				if (timeout>0 && time>=timeout) throw TimeOutException();
+			} else {
 				if (timeout>0) timer.check(timeout); // TODO: not reentrant, JN: done
 				time = timer.get_time();
-
 			}
-			catch (NoBisectableVariableException& ) {
-				update_uplo_of_epsboxes((c->box)[goal_var].lb());
-				buffer.pop();
-				delete c; // deletes the cell.
-				update_uplo(); // the heap has changed -> recalculate the uplo (eg: if not in best-first search)
 
-			}
+			if (checkpoint_due())
+				save_checkpoint(checkpoint_file);
+		}
+
+		// loup found from the last boxes queued to the background loup finder
+		if (sync_loup_finder()) {
+			buffer.contract(compute_ymax());
+			update_uplo();
 		}
 
 	 	timer.stop();
-	 	time = timer.get_time();
-
-		// No solution found and optimization stopped with empty buffer
-		// before the required precision is reached => means infeasible problem
-	 	if (uplo_of_epsboxes == NEG_INFINITY)
-	 		status = UNBOUNDED_OBJ;
-	 	else if (uplo_of_epsboxes == POS_INFINITY && (loup==POS_INFINITY || (loup==initial_loup && abs_eps_f==0 && rel_eps_f==0)))
-	 		status = INFEASIBLE;
-	 	else if (loup==initial_loup)
-	 		status = NO_FEASIBLE_FOUND;
-	 	else if (get_obj_rel_prec()>rel_eps_f && get_obj_abs_prec()>abs_eps_f)
-	 		status = UNREACHED_PREC;
-	 	else
-	 		status = SUCCESS;
+	 	time = thread_cpu_time ? thread_cpu_seconds()-thread_start : timer.get_time();
+
+	 	status = end_status();
 	}
 	catch (TimeOutException& ) {
+		stop_loup_finder();
 		status = TIME_OUT;
 	}
 
+	save_cov();
+
+	if (live_cells) live_cells->store(0, std::memory_order_relaxed);
+
+	return status;
+}
+
+Optimizer::Status Optimizer::end_status() const {
+	// No solution found and optimization stopped with empty buffer
+	// before the required precision is reached => means infeasible problem
+	if (uplo_of_epsboxes == NEG_INFINITY)
+		return UNBOUNDED_OBJ;
+	else if (uplo_of_epsboxes == POS_INFINITY && (loup==POS_INFINITY || (loup==initial_loup && abs_eps_f==0 && rel_eps_f==0)))
+		return INFEASIBLE;
+	else if (loup==initial_loup)
+		return NO_FEASIBLE_FOUND;
+	else if (get_obj_rel_prec()>rel_eps_f && get_obj_abs_prec()>abs_eps_f)
+		return UNREACHED_PREC;
+	else
+		return SUCCESS;
+}
+
+void Optimizer::save_cov() {
 	/* TODO: cannot retrieve variable names here. */
 	for (int i=0; i<(extended_COV ? n+1 : n); i++)
 		cov->data->_optim_var_names.push_back(string(""));
@@ -533,16 +897,234 @@ Optimizer::Status Optimizer::optimize() {
 		cov->add(loup_point);
 	}
 
+	cov_meta.clear();
+	cov_meta.reserve(cov_sink ? 1 : buffer.size()+1);
+	cov_meta.push_back(loup_point_meta());
+
 	while (!buffer.empty()) {
 		Cell* cell=buffer.top();
-		if (extended_COV)
-			cov->add(cell->box);
+		if (cov_sink)
+			cov_sink(*cell);
 		else {
-			read_ext_box(cell->box,tmp);
-			cov->add(tmp);
+			if (extended_COV)
+				cov->add(cell->box);
+			else {
+				read_ext_box(cell->box,tmp);
+				cov->add(tmp);
+			}
+			cov_meta.push_back(cell_meta(*cell));
 		}
 		delete buffer.pop();
 	}
+}
+
+void Optimizer::save_cell_meta(const string& cov_file, const vector<CellMeta>& meta) {
+	ofstream os((cov_file+".fda").c_str(), ios::binary);
+	if (!os) throw runtime_error("cannot write cell metadata of "+cov_file);
+
+	uint64_t size=meta.size();
+	uint64_t checksum=file_checksum(cov_file);
+	os.write(CELL_META_MAGIC, sizeof(CELL_META_MAGIC));
+	os.write((const char*) &CELL_META_VERSION, sizeof(CELL_META_VERSION));
+	os.write((const char*) &size, sizeof(size));
+	os.write((const char*) &checksum, sizeof(checksum));
+	for (const CellMeta& m : meta) {
+		uint32_t depth=m.depth;
+		int32_t var=m.bisected_var;
+		os.write((const char*) &depth, sizeof(depth));
+		os.write((const char*) &var, sizeof(var));
+		os.write((const char*) &m.temperature, sizeof(m.temperature));
+		os.write((const char*) &m.log_volume, sizeof(m.log_volume));
+	}
+	if (!os) throw runtime_error("cannot write cell metadata of "+cov_file);
+}
+
+bool Optimizer::load_cell_meta(const string& cov_file, size_t nb_boxes, vector<CellMeta>& meta) {
+	meta.clear();
+	ifstream is((cov_file+".fda").c_str(), ios::binary);
+	if (!is) return false;
+
+	char magic[sizeof(CELL_META_MAGIC)];
+	uint32_t version;
+	uint64_t size;
+	uint64_t checksum;
+	is.read(magic, sizeof(magic));
+	is.read((char*) &version, sizeof(version));
+	is.read((char*) &size, sizeof(size));
+	is.read((char*) &checksum, sizeof(checksum));
+	if (!is || !equal(magic, magic+sizeof(magic), CELL_META_MAGIC)
+			|| version!=CELL_META_VERSION || size!=nb_boxes)
+		return false;
+	// a side file left by another COV with the same number of boxes
+	// (e.g., a write interrupted between the two files)
+	if (checksum!=file_checksum(cov_file))
+		return false;
+
+	meta.resize(size);
+	for (CellMeta& m : meta) {
+		uint32_t depth;
+		int32_t var;
+		is.read((char*) &depth, sizeof(depth));
+		is.read((char*) &var, sizeof(var));
+		is.read((char*) &m.temperature, sizeof(m.temperature));
+		is.read((char*) &m.log_volume, sizeof(m.log_volume));
+		m.depth=depth;
+		m.bisected_var=var;
+	}
+	if (!is) {
+		meta.clear();
+		return false;
+	}
+	return true;
+}
+
+bool Optimizer::checkpoint_due() const {
+	if (checkpoint_file.empty()) return false;
+	return (checkpoint_period>0 && time-last_checkpoint_time>=checkpoint_period)
+		|| (checkpoint_cells>0 && nb_cells-last_checkpoint_cells>=checkpoint_cells);
+}
+
+void Optimizer::save_checkpoint(const string& filename) {
+	last_checkpoint_time=time;
+	last_checkpoint_cells=nb_cells;
+
+	// same content as save_cov(), the search being "interrupted" here
+	CovOptimData data(extended_COV ? n+1 : n, extended_COV);
+
+	for (int i=0; i<(extended_COV ? n+1 : n); i++)
+		data.data->_optim_var_names.push_back(string(""));
+
+	data.data->_optim_optimizer_status = (unsigned int) TIME_OUT;
+	data.data->_optim_uplo = uplo;
+	data.data->_optim_uplo_of_epsboxes = uplo_of_epsboxes;
+	data.data->_optim_loup = loup;
+
+	// time and cells of the previous runs (resumed search) + current run
+	data.data->_optim_time = cov->data->_optim_time + time;
+	data.data->_optim_nb_cells = cov->data->_optim_nb_cells + nb_cells;
+	data.data->_optim_loup_point = loup_point;
+
+	IntervalVector tmp(extended_COV ? n+1 : n);
+
+	// by convention, the first box has to be the loup-point.
+	if (extended_COV) {
+		write_ext_box(loup_point, tmp);
+		tmp[goal_var] = Interval(uplo,loup);
+		data.add(tmp);
+	}
+	else {
+		data.add(loup_point);
+	}
+
+	string tmp_file=filename+".tmp";
+	const CellBufferVisitable* visitable=dynamic_cast<const CellBufferVisitable*>(&buffer);
+
+	if (checkpoint_sink && visitable) {
+		// the cells go from the buffer to the file: no copy of the buffer
+		checkpoint_sink(tmp_file, data, *visitable);
+		if (rename(tmp_file.c_str(), filename.c_str())!=0)
+			throw runtime_error("cannot write checkpoint file "+filename);
+		// the metadata are in the file: a side file of an older
+		// checkpoint must not be read with it
+		remove((filename+".fda").c_str());
+		if (trace) cout << " checkpoint saved in " << filename << " (" << buffer.size() << " cells)" << endl;
+		return;
+	}
+
+	vector<CellMeta> meta;
+	meta.reserve(buffer.size()+1);
+	meta.push_back(loup_point_meta());
+
+	auto add_cell = [&](const Cell& cell) {
+		if (extended_COV)
+			data.add(cell.box);
+		else {
+			read_ext_box(cell.box,tmp);
+			data.add(tmp);
+		}
+		meta.push_back(cell_meta(cell));
+	};
+
+	if (visitable)
+		visitable->visit(add_cell);
+	else {
+		// no way to read the cells in place: empty the buffer and refill it
+		vector<Cell*> cells;
+		cells.reserve(buffer.size());
+		while (!buffer.empty()) {
+			Cell* cell=buffer.top();
+			buffer.pop();
+			add_cell(*cell);
+			cells.push_back(cell);
+		}
+		for (Cell* cell : cells)
+			buffer.push(cell);
+	}
+
+	data.save(tmp_file.c_str());
+	save_cell_meta(tmp_file, meta);
+	// the side file holds the checksum of the COV: if interrupted between
+	// the two renames, the previous COV and the new side file do not match
+	// and the side file is ignored on load.
+	if (rename((tmp_file+".fda").c_str(), (filename+".fda").c_str())!=0
+			|| rename(tmp_file.c_str(), filename.c_str())!=0)
+		throw runtime_error("cannot write checkpoint file "+filename);
+
+	if (trace) cout << " checkpoint saved in " << filename << " (" << buffer.size() << " cells)" << endl;
+}
+
+bool Optimizer::process_cell(Cell& c) {
+
+	// the cell may have been created by another optimizer (with other operators)
+	bsc.add_property(c.box, c.prop);
+	ctc.add_property(c.box, c.prop);
+	if (!async_loup)
+		loup_finder.add_property(c.box, c.prop);
+
+	loup_changed=false;
+
+	optional<BisectionPoint> pt=choose_bisection(c);
+
+	if (!pt) {
+		update_uplo_of_epsboxes((c.box)[goal_var].lb());
+		delete &c;
+		return false;
+	}
+
+	Cell* right=c.bisect_in_place(*pt);
+
+	nb_cells+=2;
+
+	handle_cell(c);
+	handle_cell(*right);
+
+	if (loup_changed)
+		buffer.contract(compute_ymax());
+
+	return true;
+}
+
+bool Optimizer::import_loup(double new_loup, const IntervalVector& new_loup_point) {
+	if (new_loup >= loup) return false;
+	loup = new_loup;
+	loup_point = new_loup_point;
+	return true;
+}
+
+Optimizer::Status Optimizer::finish(double eps_uplo, double total_time, int total_cells, bool time_out) {
+	uplo_of_epsboxes = eps_uplo;
+	time = total_time;
+	nb_cells = total_cells;
+
+	// cells pushed with an older loup may remain above the final one
+	if (loup < POS_INFINITY)
+		buffer.contract(compute_ymax());
+
+	update_uplo();
+
+	status = time_out ? TIME_OUT : end_status();
+
+	save_cov();
 
 	return status;
 }
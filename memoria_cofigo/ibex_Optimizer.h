@@ -0,0 +1,791 @@
+//============================================================================
+//                                  I B E X
+// File        : ibex_Optimizer.h
+// Author      : Gilles Chabert, Bertrand Neveu
+// Copyright   : IMT Atlantique (France)
+// License     : See the LICENSE file
+// Created     : May 14, 2012
+// Last Update : Feb 13, 2025
+//============================================================================
+
+#ifndef __IBEX_OPTIMIZER_H__
+#define __IBEX_OPTIMIZER_H__
+
+#include "ibex_Ctc.h"
+#include "ibex_Bsc.h"
+#include "ibex_LoupFinder.h"
+#include "ibex_CellBufferOptim.h"
+#include "ibex_CovOptimData.h"
+#include "ibex_OptimizerConfig.h"
+#include "ibex_Statistics.h"
+
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ibex {
+
+/**
+ * \ingroup optim
+ *
+ * \brief Cell buffer whose cells can be read without being popped
+ * (para variantes FDA).
+ *
+ * Optional interface of the buffer of an Optimizer, used by checkpoints
+ * (see Optimizer::save_checkpoint) to list the live cells without
+ * altering the selection state of the buffer.
+ */
+class CellBufferVisitable {
+public:
+	virtual ~CellBufferVisitable() { }
+
+	/**
+	 * \brief Call \a f on each cell of the buffer (in no particular order).
+	 */
+	virtual void visit(const std::function<void(const Cell&)>& f) const=0;
+};
+
+/**
+ * \defgroup optim Global Optimization
+ */
+
+/**
+ * \ingroup optim
+ *
+ * \brief Global Optimizer.
+ *
+ * This class is an implementation of the global optimization algorithm described
+ * in the AAAI'11 paper <i>Inner Regions and Interval Linearizations for Global Optimization</i>
+ * by Trombettoni et al.
+ *
+ * \remark In all the comments of this class, "loup" means "lowest upper bound" of the criterion f
+ * and "uplo" means "uppermost lower bound" of the criterion.
+ */
+class Optimizer {
+public:
+
+	/**
+	 * \brief Return status of the optimizer
+	 *
+	 * See comments for optimize(...) below.
+	 */
+	typedef enum {SUCCESS, INFEASIBLE, NO_FEASIBLE_FOUND, UNBOUNDED_OBJ, TIME_OUT, UNREACHED_PREC} Status;
+
+	/**
+	 * \brief Data of a cell not stored in the COV format (para variantes FDA).
+	 *
+	 * Saved in a side file of the COV (see #save_cell_meta) so that a
+	 * resumed search gets its cells back with the same depth, temperature
+	 * and log-volume, i.e., the same selection order in a TempBuffer.
+	 */
+	struct CellMeta {
+		unsigned int depth;
+		int bisected_var;
+		double temperature;
+		double log_volume;
+	};
+
+	/**
+	 *  \brief Create an optimizer.
+	 *
+	 * Inputs:
+	 *   \param n        - number of variables or the <b>original system</b>
+	 *   \param ctc      - contractor for <b>extended<b> boxes (of size n+1)
+	 *   \param bsc      - bisector for <b>extended<b> boxes (of size n+1)
+	 *   \param finder   - upper-bound finder
+	 *   \param buffer   - buffer of cells
+	 *   \param goal_var - index of the objective variable in a box of size n+1
+	 *
+	 * And optionally:
+	 *   \param eps_x     - absolute precision for the boxes (bisection control)
+	 *   \param rel_eps_f - relative precision of the objective (the optimizer stops once reached).
+	 *   \param abs_eps_f - absolute precision of the objective (the optimizer stops once reached).
+	 *
+	 * \warning The optimizer relies on the contractor \a ctc to contract the domain of the goal variable
+	 *          and increase the uplo. If this contractor never contracts this goal variable,
+	 *          the optimizer will only rely on the evaluation of f and will be very slow.
+	 */
+	Optimizer(int n, Ctc& ctc, Bsc& bsc, LoupFinder& finder, CellBufferOptim& buffer,
+			int goal_var,
+			double eps_x=OptimizerConfig::default_eps_x,
+			double rel_eps_f=OptimizerConfig::default_rel_eps_f,
+			double abs_eps_f=OptimizerConfig::default_abs_eps_f,
+			bool enable_statistics=false);
+
+	/**
+	 * \brief Create an optimizer from a configuration.
+	 */
+	Optimizer(OptimizerConfig& config);
+
+	/**
+	 * \brief Delete *this.
+	 */
+	virtual ~Optimizer();
+
+	/**
+	 * \brief Run the optimization.
+	 *
+	 * \param init_box             The initial box
+	 * \param obj_init_bound       (optional) can be used to specify a starting value for
+	 *                             the upper bound of the minimum (loup). The optimizer will
+	 *                             ignore all the solutions with an objective value greater
+	 *                             than this bound.
+	 *
+	 * \return SUCCESS             if the global minimum (with respect to the precision required) has been found.
+	 *                             In particular, at least one feasible point has been found, less than obj_init_bound,
+	 *                             and in the time limit.
+	 *
+	 *         INFEASIBLE          if no feasible point exist less than obj_init_bound. In particular, the function returns
+	 *                             INFEASIBLE if the initial bound "obj_init_bound" is LESS than the true minimum (this
+	 *                             case is only possible if the goal function is unbounded).
+	 *
+	 *         NO_FEASIBLE_FOUND   if no feasible point could be found less than obj_init_bound. Contrary to INFEASIBLE,
+	 *                             infeasibility is not proven here. Warning: this return value is sensitive to the abs_eps_f
+	 *                             and rel_eps_f parameters. The upperbounding makes the optimizer only looking for points
+	 *                             less than min { (1-rel_eps_f)*obj_init_bound, obj_init_bound - abs_eps_f }.
+	 *
+	 *         UNBOUNDED_OBJ       the objective function seems unbounded (tends to -oo).
+	 *
+	 *         TIMEOUT             if time is out.
+	 *
+	 *         UNREACHED_PREC      if the search is over but the resulting interval [uplo,loup] does not satisfy
+	 *                             the precision requirements. There are several possible reasons: the goal function
+	 *                             may be too pessimistic or the constraints function may be too pessimistic with
+	 *                             respect to the precision requirement (which can be too stringent). This results
+	 *                             in tiny boxes that can neither be contracted nor used as new loup candidates.
+	 *                             Finally, the eps_x parameter may be too large.
+	 *
+	 */
+	Status optimize(const IntervalVector& init_box, double obj_init_bound=POS_INFINITY);
+
+	/**
+	 * \brief Run the optimization from a set of COV data.
+	 *
+	 * The COV data contain boxes that cover the remaining search space
+	 * (typically, produced by a previous run that ended with a timeout).
+	 */
+	Status optimize(const CovOptimData& data, double obj_init_bound=POS_INFINITY);
+
+	/**
+	 * \brief Run the optimization from a COV file.
+	 *
+	 * The cell metadata of the side file (see #load_cell_meta) are
+	 * restored if it exists.
+	 */
+	Status optimize(const char* cov_file, double obj_init_bound=POS_INFINITY);
+
+	/**
+	 * \brief Start the optimization (initial box).
+	 *
+	 * Initialize the buffer with the root cell. The search is
+	 * then performed by #optimize().
+	 */
+	void start(const IntervalVector& init_box, double obj_init_bound=POS_INFINITY);
+
+	/**
+	 * \brief Start the optimization (COV data).
+	 *
+	 * \param meta - if not NULL, metadata of the boxes of \a data (same order,
+	 *               see #get_cell_meta). Otherwise, cells are created as root cells.
+	 */
+	void start(const CovOptimData& data, double obj_init_bound=POS_INFINITY,
+			const std::vector<CellMeta>* meta=NULL);
+
+	/**
+	 * \brief Run the optimization (once started).
+	 */
+	Status optimize();
+
+	/* ================ Parallel workers (para variantes FDA) ================ */
+
+	/**
+	 * \brief Process one cell taken out of the buffer.
+	 *
+	 * Same as one iteration of #optimize(): bisect \a c in place (it becomes
+	 * the left subcell), handle both subcells and contract the buffer if the
+	 * loup has changed.
+	 * The uplo is not updated: with several optimizers sharing the same
+	 * buffer, the global bounds are maintained by the caller (see #finish).
+	 *
+	 * The properties of this optimizer's operators are added to the cell
+	 * first, as it may have been created by another optimizer.
+	 *
+	 * \return false if \a c could not be bisected (epsilon-box).
+	 */
+	bool process_cell(Cell& c);
+
+	/**
+	 * \brief Adopt a loup found by another optimizer, if better than the current one.
+	 *
+	 * \return true if the loup has been replaced.
+	 */
+	bool import_loup(double loup, const IntervalVector& loup_point);
+
+	/**
+	 * \brief Wait for the background loup finder (see #async_loup) to process
+	 * its queued boxes, adopt its loup and stop it.
+	 *
+	 * \return true if the loup has been replaced.
+	 */
+	bool sync_loup_finder();
+
+	/**
+	 * \brief Stop the background loup finder without processing its queue
+	 * (e.g., on timeout).
+	 */
+	void stop_loup_finder();
+
+	/**
+	 * \brief Number of boxes dropped by the background loup finder because
+	 * its queue was full (see #async_loup).
+	 */
+	int get_loup_boxes_dropped() const;
+
+	/**
+	 * \brief Number of calls to the loup finder saved by #adaptive_loup
+	 * in the last run.
+	 */
+	int get_loup_calls_skipped() const;
+
+	/**
+	 * \brief Write the current state of the search to a COV file, without
+	 * stopping it (para variantes FDA).
+	 *
+	 * The file holds the loup-point, the cells of the buffer, the loup, the
+	 * uplo and the uplo of epsilon-boxes, like the COV of a search stopped
+	 * by a timeout: optimize(const char*) resumes the search from it.
+	 * It is written under a temporary name and then renamed, so that an
+	 * interrupted write never destroys the previous checkpoint.
+	 *
+	 * With a #checkpoint_sink (and a CellBufferVisitable buffer) the cells
+	 * are written directly from the buffer. Otherwise they are copied into
+	 * a CovOptimData saved with its side file (see #save_cell_meta); if the
+	 * buffer is not a CellBufferVisitable, its cells are popped and pushed
+	 * back.
+	 */
+	void save_checkpoint(const std::string& filename);
+
+	/**
+	 * \brief Close a search driven through #process_cell.
+	 *
+	 * Set the aggregated uplo of epsilon-boxes, time and number of cells,
+	 * update the uplo, compute the status and fill the COV data with the
+	 * cells remaining in the buffer (which is emptied).
+	 */
+	Status finish(double uplo_of_epsboxes, double time, int nb_cells, bool time_out);
+
+	/* =========================== Output ============================= */
+
+	/**
+	 * \brief Displays on standard output a report of the last call to optimize(...).
+	 *
+	 * Information provided:
+	 * <ul><li> interval of the cost  [uplo,loup]
+	 *     <li> the best feasible point found
+	 *     <li>total running time
+	 *     <li>total number of cells (~boxes) created during the exploration
+	 * </ul>
+	 */
+	void report();
+
+	/**
+	 * \brief Create the cell of a box of COV data, as #start(const CovOptimData&,double,const std::vector<CellMeta>*)
+	 * does (para variantes FDA).
+	 *
+	 * A box of a non-extended COV is contracted with the current loup.
+	 * The properties of the operators are added but the cell is not pushed
+	 * into the buffer (e.g., a buffer reading a COV file lazily calls
+	 * this function when it needs the cell).
+	 *
+	 * \return NULL if the box is empty after contraction.
+	 */
+	Cell* make_cov_cell(const IntervalVector& cov_box, bool extended, const CellMeta* meta=NULL);
+
+	/**
+	 * \brief Get the status.
+	 *
+	 * \return the status of the last call to optimize(...).
+	 */
+	Status get_status() const;
+
+	/**
+	 * \brief Get the "COV" data.
+	 */
+	const CovOptimData& get_data() const;
+
+	/**
+	 * \brief Metadata of the boxes of the "COV" data (same order; the
+	 * entry of the loup-point is not used).
+	 */
+	const std::vector<CellMeta>& get_cell_meta() const;
+
+	/**
+	 * \brief Write cell metadata to the side file of a COV file
+	 * (\a cov_file followed by ".fda").
+	 *
+	 * The side file holds a checksum of the COV file, which must therefore
+	 * be written before.
+	 */
+	static void save_cell_meta(const std::string& cov_file, const std::vector<CellMeta>& meta);
+
+	/**
+	 * \brief Read the side file of a COV file with \a nb_boxes boxes.
+	 *
+	 * \return false if there is no side file or if it does not match the
+	 *         COV file (other number of boxes or other checksum); \a meta
+	 *         is then left empty.
+	 */
+	static bool load_cell_meta(const std::string& cov_file, size_t nb_boxes, std::vector<CellMeta>& meta);
+
+	/**
+	 * \brief Get the "uplo", that is, the lowest lower bound of the objective.
+	 */
+	double get_uplo() const;
+
+	/**
+	 * \brief Get the "loup", that is, the lowest upper bound of the objective.
+	 */
+	double get_loup() const;
+
+	/**
+	 * \brief Get the feasible point corresponding to the loup.
+	 */
+	const IntervalVector& get_loup_point() const;
+
+	/**
+	 * \brief Get the relative precision on the objective obtained after last execution.
+	 */
+	double get_obj_rel_prec() const;
+
+	/**
+	 * \brief Get the absolute precision on the objective obtained after last execution.
+	 */
+	double get_obj_abs_prec() const;
+
+	/**
+	 * \brief Get the uplo of the epsilon-boxes (boxes too small to be bisected).
+	 */
+	double get_uplo_of_epsboxes() const;
+
+	/**
+	 * \brief True if the loup has changed during the last call to #process_cell.
+	 */
+	bool get_loup_changed() const;
+
+	/**
+	 * \brief Get number of cells created during the exploration.
+	 */
+	int get_nb_cells() const;
+
+	/**
+	 * \brief Get the time spent.
+	 */
+	double get_time() const;
+
+	/* =========================== Settings ============================= */
+
+	/**
+	 * \brief Number of variables.
+	 */
+	const int n;
+
+	/**
+	 * \brief Index of the goal variable y in the extended box.
+	 */
+	const int goal_var;
+
+	/**
+	 * \brief Contractor for the extended system.
+	 *
+	 * The extended system:
+	 * (y=f(x), g_1(x)<=0,...,g_m(x)<=0).
+	 */
+	Ctc& ctc;
+
+	/**
+	 * \brief Bisector.
+	 *
+	 * Must work on extended boxes.
+	 */
+	Bsc& bsc;
+
+	/**
+	 * \brief Loup finder.
+	 */
+	LoupFinder& loup_finder;
+
+	/**
+	 * \brief Cell buffer.
+	 */
+	CellBufferOptim& buffer;
+
+	/** Precision (bisection control) */
+	const Vector eps_x;
+
+	/** Relative precision on the objective */
+	const double rel_eps_f;
+
+	/** Absolute precision on the objective */
+	const double abs_eps_f;
+
+	/**
+	 * \brief Trace activation flag.
+	 *
+	 * The value can be fixed by the user.
+	 * - 0 (by default): nothing is printed
+	 * - 1:              prints every loup/uplo update.
+	 * - 2:              prints also each handled node (warning: can generate very
+	 *                   long trace).
+	 */
+	int trace;
+
+	/**
+	 * \brief Time limit.
+	 *
+	 * Maximum CPU time used by the strategy.
+	 * This parameter allows to bound time consumption.
+	 * The value can be fixed by the user.
+	 */
+	double timeout;
+
+	/**
+	 * \brief Whether the COV data produced contains the objective (extended boxes)
+	 */
+	bool extended_COV;
+
+	/**
+	 * \brief Whether the anticipated upper bounding is activated.
+	 */
+	bool anticipated_upper_bounding;
+
+	/**
+	 * \brief Whether the loup finder runs in a background thread (para variantes FDA).
+	 *
+	 * Instead of calling the loup finder on each contracted box, the box is
+	 * queued to a thread that owns the loup finder; a loup found there is
+	 * adopted when the next box is handled. The queue is bounded: when
+	 * full, the oldest box is dropped. Requires a loup finder that shares
+	 * no evaluation data with the contractor (e.g., the default one, built
+	 * on the normalized system).
+	 */
+	bool async_loup;
+
+	/**
+	 * \brief Whether calls to the loup finder are throttled where it rarely
+	 * succeeds (para variantes FDA).
+	 *
+	 * Calls and successes of the loup finder are counted per band of depth
+	 * and band of temperature of the cells. In a band with enough calls and
+	 * a low success rate, the loup finder is only called on one cell out of
+	 * a few (so that the rate keeps being measured). Not applied before the
+	 * first loup is found, nor with #async_loup.
+	 */
+	bool adaptive_loup;
+
+	/**
+	 * \brief File where #optimize() periodically saves a checkpoint
+	 * (para variantes FDA).
+	 *
+	 * Empty (default): no checkpoint. See #save_checkpoint.
+	 */
+	std::string checkpoint_file;
+
+	/**
+	 * \brief Time (in seconds) between two checkpoints (<=0: no time limit).
+	 */
+	double checkpoint_period;
+
+	/**
+	 * \brief Number of cells between two checkpoints (<=0: no limit).
+	 */
+	int checkpoint_cells;
+
+	/**
+	 * \brief Receiver of the cells left at the end of the search
+	 * (para variantes FDA).
+	 *
+	 * If set, the cells remaining in the buffer are given to it one by one
+	 * as they are popped (and deleted right after), instead of being
+	 * copied into the COV data, which then only holds the loup-point.
+	 * Used to stream them to a file with constant extra memory.
+	 */
+	std::function<void(const Cell&)> cov_sink;
+
+	/**
+	 * \brief Writer of checkpoints (para variantes FDA).
+	 *
+	 * If set (and the buffer is a CellBufferVisitable), #save_checkpoint
+	 * calls it with the temporary file to write, the COV data of the
+	 * checkpoint with only the loup-point (status, loup, uplo, time, ...)
+	 * and the buffer, whose cells are to be written as they are visited.
+	 * The file must hold the cell metadata itself: no side file is written.
+	 * Used to save checkpoints without a copy of the buffer in memory.
+	 */
+	std::function<void(const std::string& file, const CovOptimData& header,
+			const CellBufferVisitable& cells)> checkpoint_sink;
+
+	/**
+	 * \brief Whether #timeout and the reported time are measured on the CPU
+	 * time of the thread that calls #optimize() (para variantes FDA).
+	 *
+	 * By default the CPU time of the whole process is used, which also counts
+	 * the other optimizers running in the same process (several runs at once
+	 * in ibex_menu). The background loup finder (#async_loup) is not counted.
+	 */
+	bool thread_cpu_time;
+
+	/**
+	 * \brief Where #optimize() publishes the number of cells in the buffer
+	 * (para variantes FDA).
+	 *
+	 * If not NULL, updated on each iteration of the sequential search (and
+	 * set to 0 when it ends), to be read from another thread while the search
+	 * runs, e.g., to estimate its memory use.
+	 */
+	std::atomic<unsigned int>* live_cells;
+
+protected:
+
+	/**
+	 * \brief Main procedure for processing a box.
+	 *
+	 * <ul>
+	 * <li> contract the cell's box w.r.t the "loup",
+	 * <li> contract with the contractor ctc,
+	 * <li> search for a new loup,
+	 * <li> push the cell into the buffer or delete the cell in case of empty box detected.
+	 * </ul>
+	 *
+	 */
+	void handle_cell(Cell& c);
+
+
+	/**
+	 * \brief Contract and bound procedure for processing a box.
+	 *
+	 * <ul>
+	 * <li> contract the cell's box w.r.t the "loup",
+	 * <li> contract with the contractor ctc,
+	 * <li> search for a new loup,
+	 * <li> call the first order contractor
+	 * </ul>
+	 *
+	 */
+	void contract_and_bound(Cell& c);
+
+	/**
+	 * \brief Bisection point chosen by the bisector for \a c, or nothing if
+	 * \a c cannot be bisected (para variantes FDA).
+	 *
+	 * Same as bsc.choose_var, except that boxes whose variables are all too
+	 * small for the bisector are detected without throwing
+	 * NoBisectableVariableException.
+	 */
+	std::optional<BisectionPoint> choose_bisection(const Cell& c);
+
+	/**
+	 * \brief Update the uplo
+	 */
+	void update_uplo();
+
+	/**
+	 * \brief Update the uplo of non bisectable boxes
+	 */
+	void update_uplo_of_epsboxes(double ymin);
+
+	/**
+	 * \brief Main procedure for updating the loup.
+	 */
+	bool update_loup(const IntervalVector& box, BoxProperties& prop);
+
+	/**
+	 * \brief Computes and returns  the value ymax (the loup decreased with the precision)
+	 * the heap and the current box are contracted with y <= ymax
+	 */
+	double compute_ymax();
+
+	/**
+	 * \brief Status of a search that has not been interrupted by a timeout.
+	 */
+	Status end_status() const;
+
+	/**
+	 * \brief Fill the COV data with the loup-point and the cells of the buffer
+	 * (or give the cells to #cov_sink).
+	 *
+	 * The buffer is emptied.
+	 */
+	void save_cov();
+
+	/**
+	 * \brief Write the extended box "ext_box" from "box" (skipping the goal variable).
+	 */
+	void write_ext_box(const IntervalVector& box, IntervalVector& ext_box);
+
+	/**
+	 * \brief Read the original variables of "ext_box" into "box".
+	 */
+	void read_ext_box(const IntervalVector& ext_box, IntervalVector& box);
+
+	/**
+	 * \brief Statistics (NULL if not enabled)
+	 */
+	Statistics* statistics;
+
+private:
+
+	/** Currently entailed constraints */
+	//EntailedCtr* entailed;
+
+	/** Status of the last optimization */
+	Status status;
+
+	/** The current uplo. */
+	double uplo;
+
+	/** The current uplo of epsboxes (upper bound of the lower bounds of the tiny boxes). */
+	double uplo_of_epsboxes;
+
+	/** The current loup. */
+	double loup;
+
+	/** The point satisfying the constraints corresponding to the loup. */
+	IntervalVector loup_point;
+
+	/** The initial loup (obj_init_bound). */
+	double initial_loup;
+
+	/** True if loup has changed in the last call to handle_cell(..). */
+	bool loup_changed;
+
+	/** Time spent in the last call to optimize() */
+	double time;
+
+	/** Number of cells pushed into the heap (which passed through the contractors). */
+	int nb_cells;
+
+	/** Remaining search space */
+	CovOptimData* cov;
+
+	/** Metadata of the boxes of cov (see #get_cell_meta). */
+	std::vector<CellMeta> cov_meta;
+
+	/**
+	 * Widths of the current box before contraction, used to refresh
+	 * the cached log-volume of the cell (FDA variants) only on the
+	 * coordinates actually contracted. Reused from one cell to another.
+	 */
+	std::vector<double> diam_before;
+
+	/** Widths of the current box after contraction (see #diam_before). */
+	std::vector<double> diam_after;
+
+	/**
+	 * Original variables of the current box (extended box without the
+	 * goal variable), given to the loup finder. Reused from one cell to
+	 * another instead of a new vector per cell.
+	 */
+	IntervalVector x_box;
+
+	/** Background loup finder (see #async_loup). */
+	class AsyncLoupFinder;
+
+	/** Started on the first box handled with #async_loup set (NULL otherwise). */
+	AsyncLoupFinder* async_finder;
+
+	/** Total of boxes dropped by the background loup finders of this optimizer. */
+	int loup_boxes_dropped;
+
+	/** Loup finder history of a band of cells (see #adaptive_loup). */
+	struct LoupBand {
+		int calls;
+		int hits;
+		int skipped; // consecutive skipped cells
+	};
+
+	/** Bands indexed by depth band * nb of temperature bands + temperature band. */
+	std::vector<LoupBand> loup_bands;
+
+	/** Calls to the loup finder saved by #adaptive_loup. */
+	int loup_calls_skipped;
+
+	/**
+	 * \brief Band of a cell (see #adaptive_loup).
+	 */
+	LoupBand& loup_band(const Cell& c);
+
+	/**
+	 * \brief True if the loup finder is not worth calling on \a c (see #adaptive_loup).
+	 */
+	bool skip_loup_finder(const Cell& c);
+
+	/**
+	 * True once the bisector has refused a box where only the goal variable
+	 * is large enough: such boxes are then not submitted to it anymore
+	 * (see #choose_bisection).
+	 */
+	bool bsc_skips_goal;
+
+	/**
+	 * \brief Adopt the loup of the background loup finder if better.
+	 */
+	bool adopt_async_loup();
+
+	/** Time and number of cells of the last checkpoint (see #checkpoint_file). */
+	double last_checkpoint_time;
+	int last_checkpoint_cells;
+
+	/**
+	 * \brief True if a checkpoint has to be saved (see #checkpoint_file).
+	 */
+	bool checkpoint_due() const;
+};
+
+/*============================================ inline implementation ============================================ */
+
+inline Optimizer::Status Optimizer::get_status() const { return status; }
+
+inline const CovOptimData& Optimizer::get_data() const { return *cov; }
+
+inline const std::vector<Optimizer::CellMeta>& Optimizer::get_cell_meta() const { return cov_meta; }
+
+inline double Optimizer::get_uplo() const { return uplo; }
+
+inline double Optimizer::get_loup() const { return loup; }
+
+inline const IntervalVector& Optimizer::get_loup_point() const { return loup_point; }
+
+inline int Optimizer::get_loup_boxes_dropped() const { return loup_boxes_dropped; }
+
+inline int Optimizer::get_loup_calls_skipped() const { return loup_calls_skipped; }
+
+inline double Optimizer::get_uplo_of_epsboxes() const { return uplo_of_epsboxes; }
+
+inline bool Optimizer::get_loup_changed() const { return loup_changed; }
+
+inline int Optimizer::get_nb_cells() const { return nb_cells; }
+
+inline double Optimizer::get_time() const { return time; }
+
+inline double Optimizer::get_obj_rel_prec() const {
+	if (loup==POS_INFINITY)
+		return POS_INFINITY;
+	else if (loup==0)
+		if (uplo<0)
+			return POS_INFINITY;
+		else
+			return 0;
+	else
+		return (loup-uplo)/(fabs(loup));
+}
+
+inline double Optimizer::get_obj_abs_prec() const {
+	return loup-uplo;
+}
+
+} // end namespace ibex
+
+#endif // __IBEX_OPTIMIZER_H__
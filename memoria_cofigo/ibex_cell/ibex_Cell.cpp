@@ -13,7 +13,12 @@
 #include <limits.h>
 #include "ibex_Bxp.h"
 #include "ibex_Bxp.h"
+#include "ibex_LogVolume.h"
 #include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <vector>
 
 using namespace std;
 
@@ -28,16 +33,186 @@ static double deterministic_noise(uint64_t seed, uint64_t depth) {
 	return 0.5 + (z & ((uint64_t(1) << 53) - 1)) / norm; // [0.5 , 1.5)
 }
 
+namespace {
+
+/*
+ * Slab allocator for cells.
+ *
+ * Each thread has a free list; slabs of CELL_SLAB cells are obtained from
+ * the global allocator when it is empty. In the parallel mode a cell is
+ * often deleted by another thread than the one that created it, so a free
+ * list that grows beyond CELL_LOCAL_MAX hands CELL_SLAB cells over to a
+ * global list, where the other threads refill from before allocating.
+ * Slabs are never released: a cell of an exited thread may still be in the
+ * buffer. When a thread exits, its free list is handed over to the global
+ * list (CellListOwner); the list itself is a POD, so that cells deleted
+ * after that (by other thread_local destructors) still find it, and go
+ * straight to the global list.
+ */
+const size_t CELL_SLAB=256;
+const size_t CELL_LOCAL_MAX=4*CELL_SLAB;
+
+union CellBlock {
+	CellBlock* next;
+	alignas(Cell) unsigned char data[sizeof(Cell)];
+};
+
+struct CellFreeList {
+	CellBlock* head;
+	size_t size;
+	bool exited; // the thread_local destructors of the thread have run
+};
+
+thread_local CellFreeList local_cells = { NULL, 0, false };
+
+std::mutex global_cells_mutex;
+CellBlock* global_cells = NULL;
+size_t global_size = 0;
+std::vector<CellBlock*> cell_slabs; // keeps the slabs reachable
+
+// Hands the whole free list of the calling thread over to the global list.
+void release_cells() {
+	if (!local_cells.head) return;
+	CellBlock* last=local_cells.head;
+	while (last->next) last=last->next;
+
+	std::lock_guard<std::mutex> lock(global_cells_mutex);
+	last->next=global_cells;
+	global_cells=local_cells.head;
+	global_size+=local_cells.size;
+	local_cells.head=NULL;
+	local_cells.size=0;
+}
+
+// Constructed by the first refill of a thread: its destructor returns the
+// free list at thread exit (otherwise up to CELL_LOCAL_MAX cells per thread
+// are lost, and in-process benchmarks create threads for every run).
+struct CellListOwner {
+	~CellListOwner() {
+		release_cells();
+		local_cells.exited=true;
+	}
+};
+
+thread_local CellListOwner local_cells_owner;
+
+void refill_cells() {
+	if (!local_cells.exited) (void) &local_cells_owner; // odr-use: constructs it
+	{
+		std::lock_guard<std::mutex> lock(global_cells_mutex);
+		size_t n=0;
+		while (global_cells && n<CELL_SLAB) {
+			CellBlock* b=global_cells;
+			global_cells=b->next;
+			b->next=local_cells.head;
+			local_cells.head=b;
+			n++;
+		}
+		local_cells.size+=n;
+		global_size-=n;
+		if (n>0) return;
+	}
+
+	CellBlock* slab=static_cast<CellBlock*>(::operator new(CELL_SLAB*sizeof(CellBlock)));
+	{
+		std::lock_guard<std::mutex> lock(global_cells_mutex);
+		cell_slabs.push_back(slab);
+	}
+	for (size_t i=0; i<CELL_SLAB; i++) {
+		slab[i].next=local_cells.head;
+		local_cells.head=&slab[i];
+	}
+	local_cells.size+=CELL_SLAB;
+}
+
+void spill_cells() {
+	CellBlock* first=local_cells.head;
+	CellBlock* last=first;
+	for (size_t i=1; i<CELL_SLAB; i++) last=last->next;
+	local_cells.head=last->next;
+	local_cells.size-=CELL_SLAB;
+
+	std::lock_guard<std::mutex> lock(global_cells_mutex);
+	last->next=global_cells;
+	global_cells=first;
+	global_size+=CELL_SLAB;
+}
+
+} // end anonymous namespace
+
+void Cell::pool_usage(size_t& slabs, size_t& idle) {
+	std::lock_guard<std::mutex> lock(global_cells_mutex);
+	slabs=cell_slabs.size()*CELL_SLAB*sizeof(CellBlock);
+	idle=global_size*sizeof(CellBlock);
+}
+
+void* Cell::operator new(size_t size) {
+	if (size!=sizeof(Cell)) return ::operator new(size);
+	if (!local_cells.head) refill_cells();
+	CellBlock* b=local_cells.head;
+	local_cells.head=b->next;
+	local_cells.size--;
+	if (local_cells.exited) release_cells();
+	return b;
+}
+
+void Cell::operator delete(void* p, size_t size) {
+	if (!p) return;
+	if (size!=sizeof(Cell)) { ::operator delete(p); return; }
+	CellBlock* b=static_cast<CellBlock*>(p);
+	b->next=local_cells.head;
+	local_cells.head=b;
+	if (++local_cells.size>CELL_LOCAL_MAX) spill_cells();
+	else if (local_cells.exited) release_cells();
+}
+
 Cell::Cell(const IntervalVector& box, int var, unsigned int depth) :
-	box(box), prop(this->box), bisected_var(var), depth(depth), temperature(temp_T0_) {
+	box(box), prop(this->box), bisected_var(var), depth(depth), temperature(temp_T0_),
+	log_vol(0), degenerate_widths(-1) {
 
 }
 
 Cell::Cell(const Cell& e) :
-	box(e.box), prop(this->box, e.prop), bisected_var(e.bisected_var), depth(e.depth), temperature(e.temperature) {
+	box(e.box), prop(this->box, e.prop), bisected_var(e.bisected_var), depth(e.depth), temperature(e.temperature),
+	log_vol(e.log_vol), degenerate_widths(e.degenerate_widths) {
 
 }
 
+double Cell::box_log_volume(const IntervalVector& box) {
+	LogWidths w=log_widths(box);
+	return w.degenerate>0 ? POS_INFINITY : w.log_sum;
+}
+
+double Cell::get_log_volume() const {
+	if (!has_log_volume()) {
+		LogWidths w=log_widths(box);
+		log_vol = w.log_sum;
+		degenerate_widths = w.degenerate;
+	}
+	return degenerate_widths>0 ? POS_INFINITY : log_vol;
+}
+
+void Cell::update_log_volume(int var, double old_diam) {
+	if (!has_log_volume()) return;
+	double lw;
+	if (detail::log_width(old_diam, lw)) log_vol -= lw;
+	else degenerate_widths--;
+	if (detail::log_width(box[var].diam(), lw)) log_vol += lw;
+	else degenerate_widths++;
+}
+
+void Cell::reset_log_volume() {
+	degenerate_widths = -1;
+}
+
+void Cell::restore_log_volume(double lv) {
+	if (std::isfinite(lv)) {
+		log_vol = lv;
+		degenerate_widths = 0;
+	} else
+		degenerate_widths = -1;
+}
+
 pair<Cell*,Cell*> Cell::bisect(const BisectionPoint& pt) const {
 
 	Cell* cleft;
@@ -61,11 +236,53 @@ pair<Cell*,Cell*> Cell::bisect(const BisectionPoint& pt) const {
 	cleft->temperature = child_temp;
 	cright->temperature = child_temp;
 
+	if (has_log_volume()) {
+		// only the bisected coordinate changes: O(1) update from the parent
+		double d=box[pt.var].diam();
+		cleft->log_vol = cright->log_vol = log_vol;
+		cleft->degenerate_widths = cright->degenerate_widths = degenerate_widths;
+		cleft->update_log_volume(pt.var, d);
+		cright->update_log_volume(pt.var, d);
+	}
+
 	prop.update_bisect(Bisection(box, pt, cleft->box, cright->box), cleft->prop, cright->prop);
 
 	return pair<Cell*,Cell*>(cleft,cright);
 }
 
+Cell* Cell::bisect_in_place(const BisectionPoint& pt) {
+
+	// copy of the parent (box, properties, cached log-volume)
+	Cell* cright = new Cell(*this);
+
+	double d=box[pt.var].diam();
+
+	if (pt.rel_pos) {
+		pair<Interval,Interval> p=box[pt.var].bisect(pt.pos);
+		box[pt.var]=p.first;
+		cright->box[pt.var]=p.second;
+	} else {
+		cright->box[pt.var]=Interval(pt.pos, box[pt.var].ub());
+		box[pt.var]=Interval(box[pt.var].lb(), pt.pos);
+	}
+
+	double noise = temp_rand_ ? deterministic_noise(temp_seed_, depth+1) : 1.0;
+	double child_temp = (temperature/2.0) * temp_k_ * noise;
+
+	bisected_var = cright->bisected_var = pt.var;
+	depth = cright->depth = depth+1;
+	temperature = cright->temperature = child_temp;
+
+	update_log_volume(pt.var, d);
+	cright->update_log_volume(pt.var, d);
+
+	BitSet var=BitSet::singleton(box.size(), pt.var);
+	prop.update(BoxEvent(box, BoxEvent::CONTRACT, var));
+	cright->prop.update(BoxEvent(cright->box, BoxEvent::CONTRACT, var));
+
+	return cright;
+}
+
 Cell::~Cell() {
 
 }
@@ -41,10 +41,16 @@ namespace ibex {
  */
 class Cell {
 public:
-	static inline double temp_k_ = 10.0;
-	static inline double temp_T0_ = 100.0;
-	static inline bool   temp_rand_ = false;
-	static inline uint64_t temp_seed_ = 1;
+	/*
+	 * Temperature of the children (see #bisect). Per thread: several runs
+	 * with different parameters may share the process (para variantes FDA).
+	 * A thread that bisects cells of another one copies its parameters
+	 * (see #TempParams).
+	 */
+	static inline thread_local double temp_k_ = 10.0;
+	static inline thread_local double temp_T0_ = 100.0;
+	static inline thread_local bool   temp_rand_ = false;
+	static inline thread_local uint64_t temp_seed_ = 1;
 
 	static inline void set_temp_params(double k, bool rand_flag, uint64_t seed, double T0) {
 		temp_k_ = k;
@@ -52,6 +58,21 @@ public:
 		temp_seed_ = seed;
 		temp_T0_ = T0;
 	}
+
+	/** \brief Temperature parameters of the calling thread. */
+	struct TempParams {
+		double k, T0;
+		bool rand;
+		uint64_t seed;
+	};
+
+	static inline TempParams get_temp_params() {
+		return TempParams{temp_k_, temp_T0_, temp_rand_, temp_seed_};
+	}
+
+	static inline void set_temp_params(const TempParams& p) {
+		set_temp_params(p.k, p.rand, p.seed, p.T0);
+	}
 	/**
 	 * \brief Create the root cell.
 	 *
@@ -77,11 +98,95 @@ public:
 	 */
 	std::pair<Cell*,Cell*> bisect(const BisectionPoint& b) const;
 
+	/**
+	 * \brief Bisect this cell in place (para variantes FDA).
+	 *
+	 * *this becomes the left cell and the right cell is returned. Same
+	 * result as #bisect(const BisectionPoint&) followed by deleting *this,
+	 * but the parent box is copied only once (for the right cell) and no
+	 * cell is allocated for the left part.
+	 *
+	 * Properties of both cells are the parent ones, updated with a
+	 * contraction event on the bisected variable.
+	 */
+	Cell* bisect_in_place(const BisectionPoint& b);
+
 	/**
 	 * \brief Delete *this.
 	 */
 	virtual ~Cell();
 
+	/**
+	 * \brief Allocate a cell from the thread-local cell pool.
+	 *
+	 * Cells are created and deleted at every node of the search: they are
+	 * taken from slabs and recycled through a free list instead of going
+	 * through the global allocator (para variantes FDA). Objects of a
+	 * different size (derived classes) use the global operator new.
+	 */
+	static void* operator new(size_t size);
+
+	/**
+	 * \brief Give a cell back to the pool of the calling thread.
+	 *
+	 * The cell may have been allocated by another thread.
+	 */
+	static void operator delete(void* p, size_t size);
+
+	/**
+	 * \brief Memory held by the cell pool (para variantes FDA).
+	 *
+	 * \a slabs: bytes of all the slabs allocated so far (they are never
+	 * released). \a idle: bytes of the free cells in the global list, which
+	 * any thread reuses before allocating (the free lists of the threads of
+	 * finished searches end up there).
+	 */
+	static void pool_usage(size_t& slabs, size_t& idle);
+
+	/**
+	 * \brief Log10 of the box volume (para variantes FDA).
+	 *
+	 * Computed on first call and then maintained incrementally: bisection
+	 * only updates the split coordinate (see #update_log_volume).
+	 * Return +oo if some width is not finite or null.
+	 */
+	double get_log_volume() const;
+
+	/**
+	 * \brief True if the log-volume is cached (and must be kept up to date).
+	 */
+	bool has_log_volume() const;
+
+	/**
+	 * \brief Update the cached log-volume in O(1) after the width of
+	 * variable \a var changed from \a old_diam to box[var].diam().
+	 *
+	 * Does nothing if the log-volume is not cached yet.
+	 */
+	void update_log_volume(int var, double old_diam);
+
+	/**
+	 * \brief Drop the cached log-volume (recomputed in one pass on next
+	 * call to #get_log_volume). Cheaper than many #update_log_volume
+	 * calls when most of the box has changed.
+	 */
+	void reset_log_volume();
+
+	/**
+	 * \brief Set the cached log-volume to a value saved with the cell
+	 * (para variantes FDA).
+	 *
+	 * The incrementally maintained value may differ in the last bits
+	 * from a recomputation: a restored cell keeps exactly the same one.
+	 * A non-finite value just drops the cache (see #reset_log_volume).
+	 */
+	void restore_log_volume(double lv);
+
+	/**
+	 * \brief Log10 of the volume of a box (same conventions as #get_log_volume).
+	 */
+	static double box_log_volume(const IntervalVector& box);
+
 	/**
 	 * \brief The box
 	 */
@@ -111,8 +216,19 @@ public:
 	double temperature;
 
 private:
+	/** Sum of log10 of the finite and positive widths. */
+	mutable double log_vol;
+
+	/** Number of null or non-finite widths (-1 if log_vol is not computed yet). */
+	mutable int degenerate_widths;
 };
 
+/*================================== inline implementations ========================================*/
+
+inline bool Cell::has_log_volume() const {
+	return degenerate_widths>=0;
+}
+
 /**
  * \brief Print the cell.
  */
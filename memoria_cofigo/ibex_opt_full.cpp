@@ -13,36 +13,14 @@
 
 #include "ibex.h"
 #include "parse_args.h"
-#include "ibex_OptimLargestFirst.h"
-#include <memory>
 
 #include <sstream>
-#include <random>
 #include <cstring>
-#include "temp_buffer.h"
-#include <filesystem>
+#include "fda_runner.h"
 
 using namespace std;
 using namespace ibex;
 
-// Simple subclass to expose protected getters from DefaultOptimizerConfig.
-struct FdConfig : public DefaultOptimizerConfig {
-	using DefaultOptimizerConfig::DefaultOptimizerConfig;
-	using DefaultOptimizerConfig::nb_var;
-	using DefaultOptimizerConfig::get_ctc;
-	using DefaultOptimizerConfig::get_bsc;
-	using DefaultOptimizerConfig::get_loup_finder;
-	using DefaultOptimizerConfig::get_cell_buffer;
-	using DefaultOptimizerConfig::goal_var;
-	using DefaultOptimizerConfig::get_ext_sys;
-	using DefaultOptimizerConfig::get_norm_sys;
-	using DefaultOptimizerConfig::get_eps_x;
-	using DefaultOptimizerConfig::get_rel_eps_f;
-	using DefaultOptimizerConfig::get_abs_eps_f;
-	using DefaultOptimizerConfig::with_statistics;
-	using DefaultOptimizerConfig::get_trace;
-};
-
 int main(int argc, char** argv) {
 	auto exe_basename = [](const char* path) -> std::string {
 		const char* slash = strrchr(path, '/');
@@ -90,6 +68,26 @@ int main(int argc, char** argv) {
 	args::ValueFlag<string> no_split_arg(parser, "vars","Prevent some variables to be bisected, separated by '+'.\nExample: --no-split=x+y",{"no-split"});
 	args::Flag quiet(parser, "quiet", "Print no report on the standard output.",{'q',"quiet"});
 	args::ValueFlag<string> fd_mode(parser, "string", "FD mode (depth_k). Optional; if set, overrides the bisector with a depth-oriented variant.", {"fd-mode"});
+	args::ValueFlag<int>    threads(parser, "int", "Number of worker threads. Each worker has its own contractor and loup finder; "
+			"cells and loup are shared. Default value is 1 (sequential). With N>1 the timeout and the reported time are wall-clock.", {"threads"});
+	args::Flag shared_temp(parser, "shared-temp", "With --threads N>1 in FD mode, share a single TempBuffer under a lock "
+			"instead of one TempBuffer shard per worker with work stealing.", {"shared-temp"});
+	args::Flag async_loup(parser, "async-loup", "Run the loup finder of each worker in a background thread: contracted boxes are queued "
+			"to it and the loups it finds are adopted on the next box.", {"async-loup"});
+	args::Flag adaptive_loup(parser, "adaptive-loup", "Throttle the loup finder on bands of depth/temperature where it rarely "
+			"improves the loup (ignored with --async-loup).", {"adaptive-loup"});
+	args::ValueFlag<string> checkpoint(parser, "filename", "Periodically save the state of the search (cells, loup, uplo) "
+			"to this COV file, without stopping it. Sequential search only.", {"checkpoint"});
+	args::ValueFlag<double> checkpoint_every(parser, "float", "Time (in seconds) between two checkpoints. "
+			"Default value is 60 (unless --checkpoint-cells is given).", {"checkpoint-every"});
+	args::ValueFlag<int>    checkpoint_cells(parser, "int", "Number of cells between two checkpoints.", {"checkpoint-cells"});
+	args::Flag cov_stream(parser, "cov-stream", "Write the output COV in the FDA streaming format: the remaining cells are "
+			"written to the file as they leave the buffer (with their depth/temperature) instead of being kept in memory. "
+			"Files in this format are accepted by --input/--resume.", {"cov-stream"});
+	args::Flag cov_compress(parser, "cov-compress", "Same as --cov-stream, with the cell bounds encoded relative to the "
+			"loup-point and compressed with zlib.", {"cov-compress"});
+	args::ValueFlag<string> resume(parser, "filename", "Resume the search saved in a checkpoint (same as --input); "
+			"unless --checkpoint is given, new checkpoints overwrite this file.", {"resume"});
 
 	args::Positional<std::string> filename(parser, "filename", "The name of the MINIBEX file.");
 
@@ -130,444 +128,80 @@ int main(int argc, char** argv) {
 		exit(1);
 	}
 
-	try {
-
-		System *sys;
-		string exe_name = exe_basename(argv[0]);
-
-		string extension = filename.Get().substr(filename.Get().find_last_of('.')+1);
-		if (extension == "nl") {
-			cerr << "\n\033[31mAMPL files can only be read with optimizer04 (ibex-opt-extra package).\n\n";
-			exit(0);
-		}
-		else
-			// Load a system of equations
-			sys = new System(filename.Get().c_str(), simpl_level? simpl_level.Get() : ExprNode::default_simpl_level);
-
-		FdConfig config(*sys);
-
-		string output_cov_file; // cov output file
-		bool overwitten=false;  // is it overwritten?
-		string cov_copy;
-
-		if (!sys->goal) {
-			ibex_error(" input file has not goal (it is not an optimization problem).");
-		}
-
-		auto infer_mode = [&](const std::string& exe)->std::string {
-			if (exe.find("depth_k_rand")!=string::npos) return "depth_k_rand";
-			if (exe.find("depth_k")!=string::npos)      return "depth_k";
-			if (exe.find("vol_k_rand")!=string::npos)   return "vol_k_rand";
-			if (exe.find("vol_k")!=string::npos)        return "vol_k";
-			return "";
-		};
-
-		std::string inferred = infer_mode(exe_name);
-		std::string fd_choice = fd_mode ? fd_mode.Get() : inferred;
-
-		bool use_fd_variant = (fd_choice=="depth_k" || fd_choice=="depth_k_rand" ||
-		                       fd_choice=="vol_k"   || fd_choice=="vol_k_rand");
-
-		bool want_fd_logging = use_fd_variant;
-		if (want_fd_logging) {
-			cout << "  [fd-debug] sys.box empty? " << (sys->box.is_empty() ? "yes" : "no")
-			     << " unbounded? " << (sys->box.is_unbounded() ? "yes" : "no")
-			     << " dim=" << sys->nb_var << "\n";
-			if (!sys->box.is_empty() && !sys->box.is_unbounded()) {
-				try {
-					cout << "  [fd-debug] root volume: " << sys->box.volume() << "\n";
-				} catch (...) {
-					cout << "  [fd-debug] root volume: (error computing)\n";
-				}
-			}
-		}
-
-		if (!quiet) {
-			cout << endl << "************************ setup ************************" << endl;
-			cout << "  file loaded:\t\t" << filename.Get() << endl;
-		}
-
-		if (rel_eps_f) {
-			config.set_rel_eps_f(rel_eps_f.Get());
-
-			if (!quiet)
-				cout << "  rel-eps-f:\t\t" << rel_eps_f.Get() << "\t(relative precision on objective)" << endl;
-		}
-
-		if (abs_eps_f) {
-			config.set_abs_eps_f(abs_eps_f.Get());
-			if (!quiet)
-				cout << "  abs-eps-f:\t\t" << abs_eps_f.Get() << "\t(absolute precision on objective)" << endl;
-		}
-
-		if (eps_h) {
-			config.set_eps_h(eps_h.Get());
-			if (!quiet)
-				cout << "  eps-h:\t\t" << eps_h.Get() << "\t(equality thickening)" << endl;
-		}
-
-		if (eps_x_arg) {
-			if (!quiet)
-				cout << "  eps-x:\t\t" << eps_x_arg.Get() << "\t(precision on variables domain)" << endl;
-		}
-
-		Vector eps_x(sys->nb_var, eps_x_arg ? eps_x_arg.Get() : OptimizerConfig::default_eps_x);
+	string exe_name = exe_basename(argv[0]);
 
-		if (no_split_arg) {
-			if (!quiet)
-				cout << "  don't split:\t\t";
-
-			vector<const ExprNode*> no_split = parse_symbols_list(sys->args, no_split_arg.Get());
-
-			if (!quiet) {
-				for (vector<const ExprNode*>::const_iterator it=no_split.begin(); it!=no_split.end(); ++it)
-					cout << **it << ' ';
-				cout << endl;
-			}
-
-			if (!no_split.empty()) {
-				// we use VarSet for convenience (handling of indexed symbols)
-				VarSet varset(sys->f_ctrs,no_split,true);
-
-				for (int i=0; i<varset.nb_var; i++) {
-					eps_x[varset.var(i)]=POS_INFINITY;
-				}
-				for (vector<const ExprNode*>::iterator it=no_split.begin(); it!=no_split.end(); ++it) {
-					cleanup(**it,false);
-				}
-			}
-		}
-
-		config.set_eps_x(eps_x);
-
-		// This option certifies feasibility with equalities
-		if (rigor) {
-			config.set_rigor(rigor.Get());
-			if (!quiet)
-				cout << "  rigor mode:\t\tON\t(feasibility of equalities certified)" << endl;
-		}
-
-	if (kkt) {
-		config.set_kkt(kkt.Get());
-		if (!quiet)
-			cout << "  KKT contractor:\tON" << endl;
+	string extension = filename.Get().substr(filename.Get().find_last_of('.')+1);
+	if (extension == "nl") {
+		cerr << "\n\033[31mAMPL files can only be read with optimizer04 (ibex-opt-extra package).\n\n";
+		exit(0);
 	}
 
-		if (simpl_level)
-			cout << "  symbolic simpl level:\t" << simpl_level.Get() << "\t" << endl;
-
-		if (initial_loup) {
-			if (!quiet)
-				cout << "  initial loup:\t\t" << initial_loup.Get() << " (a priori upper bound of the minimum)" << endl;
-		}
-
-		// Fix the random seed for reproducibility.
-		if (random_seed) {
-			config.set_random_seed(random_seed.Get());
-			if (!quiet)
-				cout << "  random seed:\t\t" << random_seed.Get() << endl;
-		}
-
-		if (input_file) {
-			if (!quiet) {
-				cout << "  input COV file:\t" << input_file.Get().c_str() << "\n";
-			}
-		}
-
-		if (output_file) {
-			output_cov_file = output_file.Get();
-		} else {
-			// got from stackoverflow.com:
-			string::size_type const p(filename.Get().find_last_of('.'));
-			// filename without extension
-			string filename_no_ext=filename.Get().substr(0, p);
-			stringstream ss;
-			ss << filename_no_ext << ".cov";
-			output_cov_file=ss.str();
-
-			ifstream file;
-			file.open(output_cov_file.c_str(), ios::in); // to check if it exists
-
-			if (file.is_open()) {
-				overwitten = true;
-				stringstream ss;
-				ss << output_cov_file << "~";
-				cov_copy=ss.str();
-				// got from stackoverflow.com:
-				ofstream dest(cov_copy, ios::binary);
-
-			    istreambuf_iterator<char> begin_source(file);
-			    istreambuf_iterator<char> end_source;
-			    ostreambuf_iterator<char> begin_dest(dest);
-			    copy(begin_source, end_source, begin_dest);
-			}
-			file.close();
-		}
-
-		if (!quiet) {
-			cout << "  output COV file:\t" << output_cov_file << "\n";
-		}
-
-		// This option limits the search time
-		if (timeout) {
-			if (!quiet)
-				cout << "  timeout:\t\t" << timeout.Get() << "s" << endl;
-			config.set_timeout(timeout.Get());
-		}
-
-		// This option prints each better feasible point when it is found
-		if (trace) {
-			if (!quiet)
-				cout << "  trace:\t\tON" << endl;
-			config.set_trace(trace.Get());
-		}
-
-		// This option enables statistics
-		if (stats) {
-			if (!quiet)
-				cout << "  statistics:\t\tON" << endl;
-			config.set_statistics(stats.Get());
-		}
-
-		// Question: is really inHC4 good?
-		config.set_inHC4(true);
-
-		if (!config.with_inHC4()) {
-			cerr << "\n  \033[33mwarning: inHC4 disabled\033[0m (unimplemented operator)" << endl;
-		}
-
-		if (output_no_obj) {
-			cout << "  Generates COV with:\tvariable domains only\n";
-			config.set_extended_cov(false);
-		}
-
-		if (!quiet) {
-			cout << "*******************************************************" << endl << endl;
-		}
-
-		// Build the optimizer (default or FD mode)
-		Optimizer* opt_ptr = NULL;
-		std::unique_ptr<OptimLargestFirst> fd_bisector;
-		std::unique_ptr<Optimizer> opt_owner;
-		std::unique_ptr<TempBuffer> temp_buffer;
-		TempBuffer* temp_raw = nullptr;
-
-		if (use_fd_variant) {
-			string mode = fd_choice;
-			if (mode=="depth_k" || mode=="depth_k_rand" || mode=="vol_k" || mode=="vol_k_rand") {
-				// Para estas variantes, usamos un bisector OptimLargestFirst sin dividir el objetivo.
-				ExtendedSystem& ext_sys = config.get_ext_sys();
-				const Vector& ex = config.get_eps_x();
-				double eps_scalar = ex.size()>=1 ? ex[0] : OptimizerConfig::default_eps_x;
-				fd_bisector.reset(new OptimLargestFirst(ext_sys.goal_var(), /*choose_obj=*/false, eps_scalar));
-				CellBufferOptim* buffer_ptr = &config.get_cell_buffer();
-				double V0_ref = 1.0;
-				double logV_ref = 0.0;
-				if (!sys->box.is_empty() && !sys->box.is_unbounded()) {
-					try { V0_ref = sys->box.volume(); } catch (...) { V0_ref = 1.0; }
-				}
-				// Calcular log10(volumen) como respaldo si el volumen desborda.
-				auto log_volume_box = [](const IntervalVector& box)->double {
-					double acc = 0.0;
-					for (int i=0;i<box.size();++i) {
-						double w = box[i].diam();
-						if (!std::isfinite(w) || w<=0.0) return POS_INFINITY;
-						acc += std::log10(w);
-					}
-					return acc;
-				};
-				logV_ref = log_volume_box(sys->box);
-				if (!std::isfinite(V0_ref) || V0_ref<=0.0) {
-					V0_ref = 1.0; // evitamos INF/NaN
-				}
-				if (!std::isfinite(logV_ref)) {
-					try { logV_ref = std::log10(std::max(1e-12, V0_ref)); } catch (...) { logV_ref = 0.0; }
-				}
-				bool is_rand = (mode.find("_rand")!=string::npos);
-				bool use_depth = (mode.find("depth")!=string::npos);
-				bool use_vol   = (mode.find("vol")!=string::npos);
-
-				// Semilla base: si no dan random-seed, usamos un valor no determinista.
-				uint64_t seed = random_seed ? static_cast<uint64_t>(random_seed.Get()) : static_cast<uint64_t>(std::random_device{}());
-
-				auto u01 = [&]() {
-					static thread_local std::mt19937_64 gen(seed);
-					static thread_local std::uniform_real_distribution<double> dist(0.0,1.0);
-					return dist(gen);
-				};
-
-				TempBuffer::Params params;
-				// k muestreado por corrida (±20%) y con ruido de tie-break más alto
-				double k_base = 10.0;
-				double k_spread = is_rand ? 0.3 : 0.2; // más dispersión en rand
-				params.k = k_base * (1.0 + k_spread * (2.0*u01()-1.0));
-				params.k = std::max(5.0, std::min(15.0, params.k));
-				params.bias = 1e-2; // peso térmico moderado (se ajusta más abajo si dominio enorme)
-				params.T0 = 100.0;
-				// Ajustes adaptativos según el volumen inicial: dominios grandes => vol_ratio más alto, depth_cut más bajo.
-				double logV = 0.0;
-				if (V0_ref>0) logV = std::log10(std::max(1e-12, V0_ref));
-				int nv = sys->nb_var;
-				auto scale_vol = [&](double base) {
-					double v = base;
-					// Problemas grandes: permitir explorar más -> bajar umbral
-					if (logV > 6) v *= 0.7;
-					else if (logV > 3) v *= 0.85;
-					else if (logV < -2) v *= 1.3;  // problemas pequeños: disparar antes
-					if (nv > 20) v *= 0.8;         // muchos vars -> bajar umbral
-					if (nv < 8) v *= 1.2;          // pocos vars -> subir umbral
-					return v;
-				};
-				auto scale_depth = [&](int base) {
-					int d = base;
-					// Problemas grandes: permitir más profundidad
-					if (logV > 6) d = d+2;
-					else if (logV > 3) d = d+1;
-					else if (logV < -2) d = std::max(1, d-1); // problemas pequeños: menos profundidad
-					if (nv > 20) d = d+1;                     // más vars -> más profundidad
-					if (nv < 8) d = std::max(1, d-1);         // pocos vars -> menos
-					return d;
-				};
-				// depth cut muestreado por corrida (alrededor de 2-3 para disparar)
-				if (use_depth) {
-					int d = static_cast<int>(std::round(2.5 * (1.0 + 0.1 * (2.0*u01()-1.0))));
-					d = scale_depth(d);
-					params.depth_cut = std::max(2, std::min(6, d));
-					params.depth_cut_jitter = 0.1; // variación por nodo
-					params.depth_hard_cut = 0.0; // cortes duros desactivados
-				} else {
-					params.depth_cut = 0;
-				}
-				// vol cut muestreado por corrida (alrededor de 5%)
-				if (use_vol) {
-					// Umbral medio para que dispare antes: subimos el corte de volumen.
-					double v = 0.22 * (1.0 + 0.1 * (2.0*u01()-1.0));
-					v = scale_vol(v);
-					params.vol_ratio_cut = std::max(0.15, std::min(0.3, v));
-					params.vol_cut_jitter = 0.15; // variación por nodo más alta
-					params.vol_hard_ratio = 0.0; // cortes duros desactivados
-				} else {
-					params.vol_ratio_cut = 0.0;
-				}
-				params.V0_ref = V0_ref;
-				params.log_V0_ref = logV_ref;
-				params.use_log_volume = true; // usar siempre log para evitar overflow/underflow en volumen
-				// Penalizaciones desactivadas: priorizamos sólo temperatura (bias).
-				params.depth_penalty = 0.0;
-				params.vol_penalty = 0.0;
-				params.rand_k = is_rand;
-				params.rand_seed = seed;
-				params.tie_noise = 1e-3; // ruido para desempate moderado
-
-				// Ajustes extra para dominios muy grandes: reducir ruido térmico y profundidades.
-					if (logV > 6) {
-						params.bias *= 0.1;          // menos peso térmico
-						params.tie_noise *= 0.1;     // menos ruido
-						params.vol_hard_ratio = 0.03; // corte duro moderado en volumen relativo
-						if (params.vol_ratio_cut > 0.25) params.vol_ratio_cut = 0.25;
-						if (use_depth) {
-							params.depth_cut = std::max(2, std::min(4, params.depth_cut));
-							params.depth_hard_cut = params.depth_cut + 2;
-					}
-					if (is_rand) {
-						// bajar la dispersión de k en dominios enormes para no ir a rutas muy malas
-						double kspread = 0.15;
-						params.k = k_base * (1.0 + kspread * (2.0*u01()-1.0));
-						params.k = std::max(5.0, std::min(15.0, params.k));
-					}
-					} else if (logV > 3) {
-						params.bias *= 0.3;
-						params.tie_noise *= 0.3;
-						params.vol_hard_ratio = 0.025;
-						if (params.vol_ratio_cut > 0.22) params.vol_ratio_cut = 0.22;
-					}
-
-					if (use_depth || use_vol) {
-						temp_buffer.reset(new TempBuffer(ext_sys, ext_sys.goal_var(), params, *buffer_ptr));
-						temp_raw = temp_buffer.get();
-						buffer_ptr = temp_raw;
-					}
-
-				opt_owner.reset(new Optimizer(
-					config.nb_var(),
-					config.get_ctc(),
-					*fd_bisector,
-					config.get_loup_finder(),
-					*buffer_ptr,
-					config.goal_var(),
-					OptimizerConfig::default_eps_x,
-					config.get_rel_eps_f(),
-					config.get_abs_eps_f(),
-					config.with_statistics()));
-				opt_ptr = opt_owner.get();
-				if (!quiet) cout << "  fd-mode:\t\t" << mode << " (bisector OptimLargestFirst + TempBuffer)\n";
-			} else {
-				if (!quiet) cerr << "  [warning] fd-mode '" << mode << "' no soportado; usando modo base.\n";
-			}
-		}
-
-		if (!opt_ptr) {
-			opt_owner.reset(new Optimizer(config));
-			opt_ptr = opt_owner.get();
-		}
-		Optimizer& o = *opt_ptr;
-
-		// display solutions with up to 12 decimals
-		cout.precision(12);
-
-		if (!quiet)
-			cout << "running............" << endl << endl;
-
-		// Search for the optimum
-		// Get the solutions
-		if (input_file)
-			if (initial_loup)
-				o.optimize(input_file.Get().c_str(), initial_loup.Get());
-			else
-				o.optimize(input_file.Get().c_str());
-		else
-			if (initial_loup)
-				o.optimize(sys->box, initial_loup.Get());
-			else
-				o.optimize(sys->box);
-
-		if (!quiet) {
-			cout << "nodes (cells):\t\t" << o.get_nb_cells() << endl;
-		}
-
-		if (trace) cout << endl;
-
-		// Report some information (computation time, etc.)
-
-		if (!quiet)
-			o.report(); // will include statistics if they are enabled
-
-		if (temp_raw && use_fd_variant) {
-			// Línea fácil de parsear para el menú/CSV.
-			cout << "fd_triggers_total:" << temp_raw->trigger_count() << endl;
-			cout << "fd_triggers_depth:" << temp_raw->depth_trigger_count() << endl;
-			cout << "fd_triggers_vol:" << temp_raw->vol_trigger_count() << endl;
-			cout << "fd_vol_eval:" << temp_raw->vol_eval_count() << endl;
-			cout << "fd_vol_nonfinite:" << temp_raw->vol_nonfinite_count() << endl;
-			cout << "triggers_csv:" << temp_raw->trigger_count() << endl;
-		}
-
-		o.get_data().save(output_cov_file.c_str());
-
-		if (!quiet) {
-			cout << " results written in " << output_cov_file << "\n";
-			if (overwitten)
-				cout << " (old file saved in " << cov_copy << ")\n";
-		}
+	auto infer_mode = [&](const std::string& exe)->std::string {
+		if (exe.find("depth_k_rand")!=string::npos) return "depth_k_rand";
+		if (exe.find("depth_k")!=string::npos)      return "depth_k";
+		if (exe.find("vol_k_rand")!=string::npos)   return "vol_k_rand";
+		if (exe.find("vol_k")!=string::npos)        return "vol_k";
+		return "";
+	};
 
-		delete sys;
-		return 0;
+	// The search itself is in fda_runner.cpp (also called in-process by ibex_menu).
+	FdaRunOptions opt;
+	opt.filename = filename.Get();
+	opt.fd_mode = fd_mode ? fd_mode.Get() : infer_mode(exe_name);
+	if (rel_eps_f) opt.rel_eps_f = rel_eps_f.Get();
+	if (abs_eps_f) opt.abs_eps_f = abs_eps_f.Get();
+	if (eps_h) opt.eps_h = eps_h.Get();
+	if (eps_x_arg) opt.eps_x = eps_x_arg.Get();
+	if (timeout) opt.timeout = timeout.Get();
+	if (random_seed) opt.random_seed = random_seed.Get();
+	if (initial_loup) opt.initial_loup = initial_loup.Get();
+	if (simpl_level) opt.simpl_level = simpl_level.Get();
+	if (no_split_arg) opt.no_split = no_split_arg.Get();
+	opt.rigor = rigor;
+	opt.kkt = kkt;
+	opt.output_no_obj = output_no_obj;
+	opt.trace = trace;
+	opt.stats = stats;
+	opt.quiet = quiet;
+	if (threads) opt.threads = threads.Get();
+	opt.shared_temp = shared_temp;
+	opt.async_loup = async_loup;
+	opt.adaptive_loup = adaptive_loup;
+	if (input_file) opt.input_file = input_file.Get();
+	if (output_file) opt.output_file = output_file.Get();
+	if (resume) opt.resume = resume.Get();
+	if (checkpoint) opt.checkpoint = checkpoint.Get();
+	if (checkpoint_every) opt.checkpoint_every = checkpoint_every.Get();
+	if (checkpoint_cells) opt.checkpoint_cells = checkpoint_cells.Get();
+	opt.cov_stream = cov_stream;
+	opt.cov_compress = cov_compress;
+
+	FdaRunResult res = run_fda(opt);
+	if (!res.ok) {
+		cerr << "Error: " << res.error << endl;
+		return 1;
+	}
 
+	if (res.fd_stats) {
+		// Línea fácil de parsear para el menú/CSV (sumada sobre los shards).
+		cout << "fd_triggers_total:" << res.triggers.triggers << endl;
+		cout << "fd_triggers_depth:" << res.triggers.depth_triggers << endl;
+		cout << "fd_triggers_vol:" << res.triggers.vol_triggers << endl;
+		cout << "fd_vol_eval:" << res.triggers.vol_eval << endl;
+		cout << "fd_vol_nonfinite:" << res.triggers.vol_nonfinite << endl;
+		if (res.sharded)
+			cout << "fd_steals:" << res.steals << endl;
+		cout << "triggers_csv:" << res.triggers.triggers << endl;
 	}
-	catch(ibex::UnknownFileException& e) {
-		cerr << "Error: cannot read file '" << filename.Get() << "'" << endl;
+
+	if (adaptive_loup) {
+		// Llamadas al loup finder ahorradas (sumadas sobre los workers).
+		cout << "fd_loup_skipped:" << res.loup_calls_skipped << endl;
 	}
-	catch(ibex::SyntaxError& e) {
-		cout << e << endl;
+
+	if (async_loup) {
+		cout << "loup_boxes_dropped:" << res.loup_boxes_dropped << endl;
 	}
+
+	return 0;
 }
@@ -0,0 +1,105 @@
+// indexed_heap.h
+// Heap d-ario indexado (intrusivo): cada elemento guarda su posición dentro del
+// heap, así que se puede borrar o recolocar una entrada en O(log n) sin borrado
+// perezoso ni entradas obsoletas.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Traits debe proveer:
+//   double    key(uint32_t id) const;   clave (se extrae la mínima)
+//   uint64_t  tie(uint32_t id) const;   desempate entre claves iguales (menor primero)
+//   uint32_t& pos(uint32_t id) const;   posición del id en el heap (npos si no está)
+template <typename Traits, unsigned D = 4>
+class IndexedHeap {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    explicit IndexedHeap(const Traits& traits = Traits()) : traits_(traits) {}
+
+    bool empty() const { return heap_.empty(); }
+    size_t size() const { return heap_.size(); }
+    uint32_t top() const { return heap_.front(); }
+    bool contains(uint32_t id) const { return traits_.pos(id) != npos; }
+
+    void clear() {
+        for (uint32_t id : heap_) traits_.pos(id) = npos;
+        heap_.clear();
+    }
+
+    void push(uint32_t id) {
+        heap_.push_back(id);
+        sift_up(heap_.size() - 1);
+    }
+
+    uint32_t pop() {
+        uint32_t id = heap_.front();
+        erase(id);
+        return id;
+    }
+
+    void erase(uint32_t id) {
+        size_t i = traits_.pos(id);
+        traits_.pos(id) = npos;
+        uint32_t last = heap_.back();
+        heap_.pop_back();
+        if (i == heap_.size()) return;
+        heap_[i] = last;
+        traits_.pos(last) = static_cast<uint32_t>(i);
+        update_at(i);
+    }
+
+    // Recoloca el id tras un cambio de clave (decrease-key o increase-key).
+    void update(uint32_t id) { update_at(traits_.pos(id)); }
+
+private:
+    Traits traits_;
+    std::vector<uint32_t> heap_;
+
+    bool before(uint32_t a, uint32_t b) const {
+        double ka = traits_.key(a), kb = traits_.key(b);
+        return ka < kb || (ka == kb && traits_.tie(a) < traits_.tie(b));
+    }
+
+    void place(size_t i, uint32_t id) {
+        heap_[i] = id;
+        traits_.pos(id) = static_cast<uint32_t>(i);
+    }
+
+    void update_at(size_t i) {
+        if (i > 0 && before(heap_[i], heap_[(i - 1) / D])) sift_up(i);
+        else sift_down(i);
+    }
+
+    void sift_up(size_t i) {
+        uint32_t id = heap_[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (!before(id, heap_[parent])) break;
+            place(i, heap_[parent]);
+            i = parent;
+        }
+        place(i, id);
+    }
+
+    void sift_down(size_t i) {
+        uint32_t id = heap_[i];
+        const size_t n = heap_.size();
+        while (true) {
+            size_t first = D * i + 1;
+            if (first >= n) break;
+            size_t last = first + D < n ? first + D : n;
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (before(heap_[c], heap_[best])) best = c;
+            }
+            if (!before(heap_[best], id)) break;
+            place(i, heap_[best]);
+            i = best;
+        }
+        place(i, id);
+    }
+};
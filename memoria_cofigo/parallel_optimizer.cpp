@@ -0,0 +1,237 @@
+// parallel_optimizer.cpp
+// Implementación del buffer concurrente y del driver de workers.
+
+#include "parallel_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace ibex;
+
+ConcurrentBuffer::ConcurrentBuffer(CellBufferOptim& inner) : inner_(inner) {}
+
+void ConcurrentBuffer::add_property(const IntervalVector& init_box, BoxProperties& prop) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inner_.add_property(init_box, prop);
+}
+
+void ConcurrentBuffer::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inner_.flush();
+    busy_ = 0;
+    stop_ = false;
+}
+
+unsigned int ConcurrentBuffer::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inner_.size();
+}
+
+bool ConcurrentBuffer::empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inner_.empty();
+}
+
+void ConcurrentBuffer::push(Cell* cell) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inner_.push(cell);
+    }
+    cv_.notify_one();
+}
+
+Cell* ConcurrentBuffer::pop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inner_.pop();
+}
+
+Cell* ConcurrentBuffer::top() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inner_.top();
+}
+
+double ConcurrentBuffer::minimum() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inner_.minimum();
+}
+
+void ConcurrentBuffer::contract(double loup) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inner_.contract(loup);
+}
+
+std::ostream& ConcurrentBuffer::print(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    os << "ConcurrentBuffer(size=" << inner_.size() << ", busy=" << busy_ << ")";
+    return os;
+}
+
+Cell* ConcurrentBuffer::take() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Con el buffer vacío sólo se puede terminar si nadie más puede empujar hijos.
+    cv_.wait(lock, [this] { return stop_ || !inner_.empty() || busy_ == 0; });
+    if (stop_ || inner_.empty()) {
+        cv_.notify_all();
+        return nullptr;
+    }
+    busy_++;
+    // top() antes de pop(): mismo orden que Optimizer::optimize (TempBuffer
+    // y CellDoubleHeap eligen la celda en top()).
+    Cell* c = inner_.top();
+    inner_.pop();
+    return c;
+}
+
+void ConcurrentBuffer::release() {
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_--;
+        idle = (busy_ == 0 && inner_.empty());
+    }
+    if (idle) cv_.notify_all();
+}
+
+void ConcurrentBuffer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+}
+
+ParallelOptimizer::ParallelOptimizer(const std::vector<Optimizer*>& workers,
+                                     SharedCellBuffer& buffer,
+                                     double timeout)
+    : workers_(workers),
+      buffer_(buffer),
+      timeout_(timeout),
+      loup_point_(workers.front()->get_loup_point()),
+      in_flight_(new std::atomic<double>[workers.size()]) {}
+
+Optimizer::Status ParallelOptimizer::optimize(const IntervalVector& init_box, double obj_init_bound) {
+    workers_.front()->start(init_box, obj_init_bound);
+    return run();
+}
+
+Optimizer::Status ParallelOptimizer::optimize(const char* cov_file, double obj_init_bound) {
+    CovOptimData data(cov_file);
+    std::vector<Optimizer::CellMeta> meta;
+    Optimizer::load_cell_meta(cov_file, data.size(), meta);
+    return optimize(data, obj_init_bound, meta.empty() ? nullptr : &meta);
+}
+
+Optimizer::Status ParallelOptimizer::optimize(const CovOptimData& data, double obj_init_bound,
+                                              const std::vector<Optimizer::CellMeta>* meta) {
+    workers_.front()->start(data, obj_init_bound, meta);
+    return run();
+}
+
+Optimizer::Status ParallelOptimizer::run() {
+    Optimizer& master = *workers_.front();
+
+    // El maestro ya procesó la raíz (o cargó el COV): su loup es el inicial.
+    loup_.store(master.get_loup());
+    loup_point_ = master.get_loup_point();
+    eps_uplo_.store(master.get_uplo_of_epsboxes());
+    for (size_t w = 0; w < workers_.size(); w++) in_flight_[w].store(POS_INFINITY);
+    timed_out_.store(false);
+
+    // Tiempo de reloj: el Timer de Ibex mide CPU del proceso, que con N
+    // hilos avanza N veces más rápido y dispararía el timeout antes de tiempo.
+    auto t0 = std::chrono::steady_clock::now();
+    if (timeout_ > 0)
+        deadline_ = t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(timeout_));
+
+    // Los hilos heredan el entorno de punto flotante (modo de redondeo) del
+    // hilo que los crea, que es el que Ibex inicializó. Los parámetros de
+    // temperatura de Cell son por hilo: se copian los de éste.
+    Cell::TempParams temp = Cell::get_temp_params();
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers_.size(); w++) {
+        Optimizer* o = workers_[w];
+        threads.emplace_back([this, o, w, temp] {
+            Cell::set_temp_params(temp);
+            worker_loop(*o, w);
+        });
+    }
+    worker_loop(master, 0);
+    for (auto& t : threads) t.join();
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    // Resultados agregados sobre el maestro.
+    double eps_uplo = POS_INFINITY;
+    int nb_cells = 0;
+    for (Optimizer* o : workers_) {
+        eps_uplo = std::min(eps_uplo, o->get_uplo_of_epsboxes());
+        nb_cells += o->get_nb_cells();
+    }
+    master.import_loup(loup_.load(), loup_point_);
+
+    return master.finish(eps_uplo, elapsed, nb_cells, timed_out_.load());
+}
+
+void ParallelOptimizer::worker_loop(Optimizer& o, size_t w) {
+    buffer_.bind(w);
+    while (Cell* c = buffer_.take()) {
+        in_flight_[w].store(c->box[o.goal_var].lb());
+        sync_loup(o);
+        if (!o.process_cell(*c)) publish_eps_uplo(o);
+        if (o.get_loup_changed()) publish_loup(o);
+        in_flight_[w].store(POS_INFINITY);
+        buffer_.release();
+
+        if (o.get_uplo_of_epsboxes() == NEG_INFINITY) {
+            buffer_.stop(); // objetivo no acotado
+        } else if (precision_reached(o)) {
+            buffer_.stop();
+        } else if (timeout_ > 0 && std::chrono::steady_clock::now() >= deadline_) {
+            timed_out_.store(true);
+            buffer_.stop();
+        }
+    }
+    // Cajas aún encoladas en el loup finder en segundo plano (--async-loup).
+    if (timed_out_.load())
+        o.stop_loup_finder();
+    else if (o.sync_loup_finder())
+        publish_loup(o);
+}
+
+void ParallelOptimizer::sync_loup(Optimizer& o) {
+    if (loup_.load(std::memory_order_acquire) >= o.get_loup()) return;
+    std::lock_guard<std::mutex> lock(loup_mutex_);
+    o.import_loup(loup_.load(std::memory_order_relaxed), loup_point_);
+}
+
+void ParallelOptimizer::publish_loup(Optimizer& o) {
+    std::lock_guard<std::mutex> lock(loup_mutex_);
+    if (o.get_loup() < loup_.load(std::memory_order_relaxed)) {
+        loup_point_ = o.get_loup_point();
+        loup_.store(o.get_loup(), std::memory_order_release);
+    }
+}
+
+void ParallelOptimizer::publish_eps_uplo(Optimizer& o) {
+    double v = o.get_uplo_of_epsboxes();
+    double cur = eps_uplo_.load();
+    while (v < cur && !eps_uplo_.compare_exchange_weak(cur, v)) {}
+}
+
+bool ParallelOptimizer::precision_reached(const Optimizer& o) const {
+    // Mismo criterio de parada que Optimizer::optimize, con el loup compartido.
+    // El uplo incluye las celdas que otros workers están procesando (ya no
+    // están en el buffer); finish() lo recalcula con todos los hilos detenidos.
+    if (o.anticipated_upper_bounding) return false;
+    double loup = loup_.load();
+    if (loup == POS_INFINITY) return false;
+
+    double uplo = std::min(buffer_.minimum(), eps_uplo_.load());
+    for (size_t w = 0; w < workers_.size(); w++) uplo = std::min(uplo, in_flight_[w].load());
+    if (uplo == POS_INFINITY) return false; // buffer vacío: take() ya termina
+
+    double rel = loup == 0 ? (uplo < 0 ? POS_INFINITY : 0) : (loup - uplo) / std::fabs(loup);
+    return rel < o.rel_eps_f || loup - uplo < o.abs_eps_f;
+}
@@ -0,0 +1,107 @@
+// parallel_optimizer.h
+// Branch-and-bound en paralelo (--threads N). Cada worker es un
+// ibex::Optimizer con sus propios Ctc/Bsc/LoupFinder (construidos desde su
+// propia configuración); todos comparten un buffer concurrente y el loup.
+
+#pragma once
+
+#include "ibex.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Buffer compartido por los workers: además de la interfaz de Ibex lleva la
+// cuenta de los workers ocupados para detectar el fin de la búsqueda.
+class SharedCellBuffer : public ibex::CellBufferOptim {
+public:
+    // Asocia el hilo llamante al worker `worker` (antes de su primer take()).
+    virtual void bind(size_t worker) { (void) worker; }
+
+    // Saca una celda y marca al worker como ocupado. Si no hay celdas espera
+    // mientras otro worker siga ocupado (puede empujar hijos).
+    // Devuelve nullptr cuando la búsqueda terminó o se llamó a stop().
+    virtual ibex::Cell* take() = 0;
+
+    // El worker terminó de procesar la celda obtenida con take().
+    virtual void release() = 0;
+
+    // Detiene la búsqueda: take() devuelve nullptr en todos los workers.
+    virtual void stop() = 0;
+};
+
+// Envoltorio con mutex de un CellBufferOptim (TempBuffer o el buffer por
+// defecto), compartido por todos los workers.
+class ConcurrentBuffer : public SharedCellBuffer {
+public:
+    explicit ConcurrentBuffer(ibex::CellBufferOptim& inner);
+
+    void add_property(const ibex::IntervalVector& init_box, ibex::BoxProperties& prop) override;
+    void flush() override;
+    unsigned int size() const override;
+    bool empty() const override;
+    void push(ibex::Cell* cell) override;
+    ibex::Cell* pop() override;
+    ibex::Cell* top() const override;
+    double minimum() const override;
+    void contract(double loup) override;
+    std::ostream& print(std::ostream& os) const override;
+
+    ibex::Cell* take() override;
+    void release() override;
+    void stop() override;
+
+private:
+    ibex::CellBufferOptim& inner_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    unsigned int busy_ = 0;
+    bool stop_ = false;
+};
+
+class ParallelOptimizer {
+public:
+    // workers[0] es el maestro: arranca la búsqueda (celda raíz o COV) y al
+    // final recibe los resultados agregados (report(), get_data(), ...).
+    // Todos los workers deben haberse construido sobre `buffer`.
+    // timeout en segundos de reloj (<= 0: sin límite).
+    ParallelOptimizer(const std::vector<ibex::Optimizer*>& workers,
+                      SharedCellBuffer& buffer,
+                      double timeout);
+
+    ibex::Optimizer::Status optimize(const ibex::IntervalVector& init_box,
+                                     double obj_init_bound = ibex::POS_INFINITY);
+    ibex::Optimizer::Status optimize(const char* cov_file,
+                                     double obj_init_bound = ibex::POS_INFINITY);
+    // meta: metadatos de las cajas de data (ver Optimizer::start), o nullptr.
+    ibex::Optimizer::Status optimize(const ibex::CovOptimData& data,
+                                     double obj_init_bound,
+                                     const std::vector<ibex::Optimizer::CellMeta>* meta);
+
+private:
+    std::vector<ibex::Optimizer*> workers_;
+    SharedCellBuffer& buffer_;
+    double timeout_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::atomic<bool> timed_out_{false};
+
+    // Loup compartido: el atómico permite consultarlo sin lock en cada celda;
+    // el punto se protege con loup_mutex_.
+    std::atomic<double> loup_{ibex::POS_INFINITY};
+    std::mutex loup_mutex_;
+    ibex::IntervalVector loup_point_;
+
+    // Para el criterio de precisión: mínimo uplo de las eps-boxes de todos los
+    // workers y lb de la celda que procesa cada uno (+inf si ninguna).
+    std::atomic<double> eps_uplo_{ibex::POS_INFINITY};
+    std::unique_ptr<std::atomic<double>[]> in_flight_;
+
+    ibex::Optimizer::Status run();
+    void worker_loop(ibex::Optimizer& o, size_t w);
+    void sync_loup(ibex::Optimizer& o);
+    void publish_loup(ibex::Optimizer& o);
+    void publish_eps_uplo(ibex::Optimizer& o);
+    bool precision_reached(const ibex::Optimizer& o) const;
+};
@@ -1,14 +1,23 @@
 // run_menu.cpp
 // Pequeño menú para lanzar variantes FDA o ibex_opt_full en paralelo.
+// Las corridas se hacen en este mismo proceso, una por hilo (fda_runner);
+// con --isolate cada una lanza ibex_opt_full en un proceso aparte (más
+// lento, pero una corrida que se cae no arrastra al resto del barrido).
+// En el barrido completo se admiten corridas nuevas mientras la memoria
+// estimada de las que están en curso no supere un presupuesto (--mem-budget).
+// Cada worker se fija a un core físico propio (--pin), que queda en el CSV.
 
 #include <atomic>
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <limits>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
 #include <filesystem>
 #include <mutex>
 #include <string>
@@ -17,12 +26,24 @@
 #include <vector>
 #include <random>
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "fda_runner.h"
+
+extern char** environ;
+
 using namespace std;
 namespace fs = std::filesystem;
 
 struct VariantInfo {
     string name;
-    string binary;
+    string binary;  // sólo con --isolate
     string fd_mode; // opcional: modo FD para ibex_opt_full
     double timeout = 0.0; // timeout opcional en segundos
 };
@@ -43,13 +64,140 @@ struct RunResult {
     long triggers_vol = -1;
     long vol_eval = -1;
     long vol_nonfinite = -1;
+    size_t peak_rss = 0; // --isolate: memoria máxima del proceso (bytes)
+};
+
+// Memoria de una corrida en curso, para la admisión del barrido completo.
+struct RunMemory {
+    std::atomic<unsigned int> live_cells{0}; // celdas en el buffer (en proceso)
+    std::atomic<pid_t> pid{0};               // proceso hijo (--isolate)
+};
+
+// VmRSS en bytes de /proc/<pid>/status ("self": este proceso); 0 si no se puede leer.
+size_t read_rss(const string& pid) {
+    ifstream in("/proc/" + pid + "/status");
+    string line;
+    while (getline(in, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) return strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+    return 0;
+}
+
+// MemAvailable de /proc/meminfo en bytes; 0 si no se puede leer.
+size_t mem_available() {
+    ifstream in("/proc/meminfo");
+    string line;
+    while (getline(in, line)) {
+        if (line.compare(0, 13, "MemAvailable:") == 0) return strtoull(line.c_str() + 13, nullptr, 10) * 1024;
+    }
+    return 0;
+}
+
+void set_csv_line(RunResult& res, const string& variant, int run_id,
+                  double best, long nodes, double elapsed, bool optimal);
+
+// Core físico para una corrida: su primer CPU lógico (los hermanos SMT
+// quedan libres) y su dominio de L3.
+struct CoreSlot {
+    int cpu;
+    int l3; // -1 si no se conoce
 };
 
-// Ejecuta ibex_opt_full y extrae nodos, tiempo, loup; formato CSV.
-RunResult run_ibex_base(const string& cmd, const string& variant, int run_id) {
-    FILE* pipe = popen(cmd.c_str(), "r");
+// Primer entero de un archivo de /sys; -1 si no existe.
+int read_sys_int(const string& path) {
+    ifstream in(path);
+    int v = -1;
+    if (!(in >> v)) return -1;
+    return v;
+}
+
+// Dominio de L3 del CPU: id del caché de nivel 3 (o su lista de CPUs, en
+// kernels sin "id"), numerado en orden de aparición.
+int l3_domain(int cpu, map<string, int>& domains) {
+    string base = "/sys/devices/system/cpu/cpu" + to_string(cpu) + "/cache/";
+    for (int i = 0; ; ++i) {
+        string index = base + "index" + to_string(i) + "/";
+        int level = read_sys_int(index + "level");
+        if (level < 0) return -1;
+        if (level != 3) continue;
+        string key;
+        ifstream id(index + "id");
+        if (!(id >> key)) {
+            ifstream shared(index + "shared_cpu_list");
+            shared >> key;
+        }
+        if (key.empty()) return -1;
+        auto it = domains.emplace(key, static_cast<int>(domains.size())).first;
+        return it->second;
+    }
+}
+
+// Cores físicos que este proceso puede usar, leídos de la topología de
+// /sys: uno por (paquete, core_id). Con one_per_l3 se deja uno por dominio
+// de L3 (las corridas no comparten caché). Se ordenan alternando dominios
+// para que pocas corridas a la vez queden repartidas.
+vector<CoreSlot> physical_cores(bool one_per_l3) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return {};
+    map<pair<int, int>, CoreSlot> by_core;
+    map<string, int> domains;
+    set<int> l3_taken;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        string topo = "/sys/devices/system/cpu/cpu" + to_string(cpu) + "/topology/";
+        int package = read_sys_int(topo + "physical_package_id");
+        int core = read_sys_int(topo + "core_id");
+        // Sin topología: cada CPU lógico cuenta como un core.
+        pair<int, int> key = (package < 0 || core < 0) ? make_pair(-1 - cpu, 0) : make_pair(package, core);
+        if (by_core.count(key)) continue;
+        int l3 = l3_domain(cpu, domains);
+        if (one_per_l3 && l3 >= 0 && !l3_taken.insert(l3).second) continue;
+        by_core[key] = CoreSlot{cpu, l3};
+    }
+    map<int, vector<CoreSlot>> by_l3;
+    for (auto& kv : by_core) by_l3[kv.second.l3].push_back(kv.second);
+    for (auto& kv : by_l3)
+        sort(kv.second.begin(), kv.second.end(), [](const CoreSlot& a, const CoreSlot& b) { return a.cpu < b.cpu; });
+    vector<CoreSlot> cores;
+    for (size_t i = 0; cores.size() < by_core.size(); ++i)
+        for (auto& kv : by_l3)
+            if (i < kv.second.size()) cores.push_back(kv.second[i]);
+    return cores;
+}
+
+// Fija el hilo actual (y los procesos o hilos que lance) a un CPU.
+bool pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// Ejecuta ibex_opt_full y extrae nodos, tiempo, loup; formato CSV. El
+// proceso se lanza con posix_spawn (sin shell) para conocer su pid, que se
+// publica en mem->pid mientras corre.
+RunResult run_ibex_base(const vector<string>& args, const string& variant, int run_id, RunMemory* mem) {
     RunResult res;
-    if (!pipe) return res;
+    int fds[2];
+    // O_CLOEXEC: los otros hijos lanzados a la vez no heredan el pipe.
+    if (pipe2(fds, O_CLOEXEC) != 0) return res;
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    vector<char*> argv;
+    for (const string& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+    pid_t pid = 0;
+    int err = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (err != 0) {
+        close(fds[0]);
+        return res;
+    }
+    if (mem) mem->pid.store(pid);
+    FILE* pipe = fdopen(fds[0], "r");
     char buf[4096];
     string line;
     double best = 0.0;
@@ -95,8 +243,60 @@ RunResult run_ibex_base(const string& cmd, const string& variant, int run_id) {
             }
         }
     }
-    pclose(pipe);
-        // CSV: run,variant,best_value,nodes,elapsed,max_depth,avg_depth,optimal,triggers
+    fclose(pipe);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == pid)
+        res.peak_rss = static_cast<size_t>(usage.ru_maxrss) * 1024; // en KB
+    if (mem) mem->pid.store(0);
+    set_csv_line(res, variant, run_id, best, nodes, elapsed, optimal);
+    return res;
+}
+
+// Corre la variante en este proceso (sin COV de salida) con las mismas
+// opciones que run_ibex_base pasa por línea de comandos. El sistema se
+// copia del ya leído en `systems` por otra corrida del mismo problema.
+RunResult run_ibex_inproc(const VariantInfo& v, const string& problem, long long seed, int run_id,
+                          SystemCache& systems, RunMemory* mem) {
+    FdaRunOptions opt;
+    opt.filename = problem;
+    opt.fd_mode = v.fd_mode;
+    opt.random_seed = static_cast<double>(seed);
+    if (v.timeout > 0.0) opt.timeout = v.timeout;
+    opt.quiet = true;
+    opt.save_cov = false;
+    opt.thread_time = true; // otras corridas comparten el proceso
+    opt.cache = &systems;   // el .bch se lee una vez por problema
+    if (mem) opt.live_cells = &mem->live_cells;
+    FdaRunResult r = run_fda(opt);
+    RunResult res;
+    if (!r.ok) {
+        cerr << "  [error] " << v.name << " run " << run_id << ": " << r.error << "\n";
+        return res;
+    }
+    if (r.fd_stats) {
+        res.triggers_total = static_cast<long>(r.triggers.triggers);
+        res.triggers_depth = static_cast<long>(r.triggers.depth_triggers);
+        res.triggers_vol = static_cast<long>(r.triggers.vol_triggers);
+        res.vol_eval = static_cast<long>(r.triggers.vol_eval);
+        res.vol_nonfinite = static_cast<long>(r.triggers.vol_nonfinite);
+    }
+    set_csv_line(res, v.name, run_id, r.loup, r.nb_cells, r.time,
+                 r.status == ibex::Optimizer::SUCCESS);
+    return res;
+}
+
+// Argumentos de ibex_opt_full para una corrida (--isolate).
+vector<string> ibex_command(const VariantInfo& v, const string& problem, long long seed) {
+    vector<string> args = {v.binary, problem, "--random-seed=" + std::to_string(seed)};
+    if (!v.fd_mode.empty()) args.push_back("--fd-mode=" + v.fd_mode);
+    if (v.timeout > 0.0)    args.push_back("--timeout=" + std::to_string(v.timeout));
+    return args;
+}
+
+// CSV: run,variant,best_value,nodes,elapsed,max_depth,avg_depth,optimal,triggers
+void set_csv_line(RunResult& res, const string& variant, int run_id,
+                  double best, long nodes, double elapsed, bool optimal) {
     stringstream ss;
     ss << run_id << "," << variant << "," << best << "," << nodes << "," << elapsed
        << ",NA,NA," << (optimal ? 1 : 0) << ",";
@@ -110,10 +310,78 @@ RunResult run_ibex_base(const string& cmd, const string& variant, int run_id) {
     ss << ",";
     if (res.vol_nonfinite>=0) ss << res.vol_nonfinite; else ss << "0";
     res.csv_line = ss.str();
-    return res;
 }
 
-int main() {
+// Una corrida del barrido completo (opción 6).
+struct Job {
+    string prob_path;
+    string prob_name;
+    const VariantInfo* variant;
+    int run;
+    double expected; // segundos estimados, para ordenar la cola
+    string csv;
+    string trig_csv;
+};
+
+// Promedio de la columna elapsed de un results_*.csv; -1 si no hay datos.
+double mean_elapsed(const string& csv) {
+    ifstream in(csv);
+    string line;
+    if (!in || !getline(in, line)) return -1; // cabecera
+    double sum = 0.0;
+    int count = 0;
+    while (getline(in, line)) {
+        // run,variant,problem,best_value,nodes,elapsed,...
+        stringstream ss(line);
+        string field;
+        for (int i = 0; i < 6 && getline(ss, field, ','); ++i) {}
+        char* end = nullptr;
+        double t = strtod(field.c_str(), &end);
+        if (end != field.c_str() && t >= 0) { sum += t; count++; }
+    }
+    return count ? sum / count : -1;
+}
+
+int main(int argc, char** argv) {
+    bool isolate = false;
+    double mem_budget_gb = 0.0; // 0: 80% de la memoria disponible al inicio
+    string pin = "core";        // core: un core físico por worker; l3: uno por dominio de L3; none
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--isolate") == 0) isolate = true;
+        else if (strncmp(argv[i], "--mem-budget=", 13) == 0) mem_budget_gb = atof(argv[i] + 13);
+        else if (strncmp(argv[i], "--pin=", 6) == 0) pin = argv[i] + 6;
+        else {
+            cerr << "Uso: " << argv[0] << " [--isolate] [--mem-budget=GB] [--pin=core|l3|none]\n";
+            return 1;
+        }
+    }
+    if (pin != "core" && pin != "l3" && pin != "none") {
+        cerr << "--pin debe ser core, l3 o none\n";
+        return 1;
+    }
+    // Los hilos fijados a un CPU pasan su máscara a los procesos que lanzan
+    // (--isolate) y a los hilos de la corrida.
+    vector<CoreSlot> cores;
+    if (pin != "none") {
+        cores = physical_cores(pin == "l3");
+        if (cores.empty()) cerr << "  [warning] no se pudo leer la topología de CPUs; corridas sin fijar.\n";
+        else cout << "Corridas fijadas a " << cores.size() << (pin == "l3" ? " dominios de L3" : " cores físicos") << ".\n";
+    }
+    // CPU de la corrida i-ésima de un worker; "NA" si no se fija.
+    auto pin_worker = [&cores](size_t w) -> string {
+        if (cores.empty()) return "NA";
+        int cpu = cores[w % cores.size()].cpu;
+        return pin_thread(cpu) ? to_string(cpu) : "NA";
+    };
+    SystemCache systems;
+    auto run_one = [&isolate, &systems](const VariantInfo& v, const string& problem, long long seed, int run_id,
+                                        RunMemory* mem) {
+        if (isolate) return run_ibex_base(ibex_command(v, problem, seed), v.name, run_id, mem);
+        return run_ibex_inproc(v, problem, seed, run_id, systems, mem);
+    };
+    cout << (isolate ? "Corridas en procesos separados (ibex_opt_full).\n"
+                     : "Corridas en este proceso (--isolate para procesos separados).\n");
+
     auto now_str = []() {
         auto now = chrono::system_clock::now();
         time_t tt = chrono::system_clock::to_time_t(now);
@@ -160,6 +428,21 @@ int main() {
         return s > 0 ? s : -1;
     };
 
+    // El generador aleatorio de Ibex es global al proceso y no es seguro
+    // entre hilos (ver fda_threaded_search): varias corridas a la vez van en
+    // procesos separados. Aun con un RNG por hilo, con semilla base también,
+    // para que cada corrida sea reproducible sola.
+    auto isolate_if_needed = [&isolate](long long seed_base, unsigned parallel) {
+        if (isolate) return;
+        if (parallel > 1 && !fda_threaded_search)
+            cout << "Varias corridas a la vez: en procesos separados (--isolate); el RNG de Ibex es global al proceso.\n";
+        else if (seed_base > 0)
+            cout << "Semilla base fija: corridas en procesos separados (--isolate), para que sean reproducibles.\n";
+        else
+            return;
+        isolate = true;
+    };
+
     auto make_seed_for_run = [&](long long seed_base) {
         return [seed_base](int run_id) -> long long {
             if (seed_base > 0) return seed_base + run_id;
@@ -254,96 +537,238 @@ int main() {
         auto seed_for_run = make_seed_for_run(seed_base);
 
         fs::create_directories("results");
-    auto run_problem = [&](const string& prob_path) {
-        string prob_name = fs::path(prob_path).filename().string();
-        // Excluir problemas lentos conocidos
+
+        // Cola global de corridas (problema, variante, repetición) del
+        // barrido: las más largas según los CSV de la corrida anterior van
+        // primero, y un worker libre toma la siguiente sin esperar a que
+        // termine el problema actual.
+        const int runs = 10;
         static const std::vector<std::string> kSkip = {"schwefel5.bch", "schwefel5-abs.bch", "ex8_5_2_1.bch", "ex7_3_4.bch"};
-        if (std::find(kSkip.begin(), kSkip.end(), prob_name) != kSkip.end()) {
-            cout << "  [skip] " << prob_name << "\n";
-            return;
-        }
+        vector<string> problems;
+        if (run_medium) problems.insert(problems.end(), medium.begin(), medium.end());
+        if (run_hard)   problems.insert(problems.end(), hard.begin(), hard.end());
+
+        vector<Job> jobs;
+        map<string, int> remaining; // corridas pendientes por problema
+        for (const string& prob_path : problems) {
+            string prob_name = fs::path(prob_path).filename().string();
+            // Excluir problemas lentos conocidos
+            if (std::find(kSkip.begin(), kSkip.end(), prob_name) != kSkip.end()) {
+                cout << "  [skip] " << prob_name << "\n";
+                continue;
+            }
+            string stem = fs::path(prob_name).stem().string();
+            // Tiempos de la corrida anterior, antes de reiniciar los CSV.
+            vector<double> expected;
+            double known = 0.0;
+            int nb_known = 0;
             for (const VariantInfo* vp : selected) {
-                // CSV por problema y variante (se reinicia en cada problema).
-                string csv = "results/results_" + vp->name + "_" + fs::path(prob_name).stem().string() + ".csv";
-                string trig_csv = "results/triggers_" + vp->name + "_" + fs::path(prob_name).stem().string() + ".csv";
+                double t = mean_elapsed("results/results_" + vp->name + "_" + stem + ".csv");
+                expected.push_back(t);
+                if (t >= 0) { known += t; nb_known++; }
+            }
+            for (size_t v = 0; v < selected.size(); ++v) {
+                const VariantInfo* vp = selected[v];
+                // Sin datos: el promedio de las otras variantes o, si no hay
+                // ninguno, el timeout (lo desconocido se trata como largo).
+                double t = expected[v];
+                if (t < 0) t = nb_known ? known / nb_known : vp->timeout;
+
+                // CSV por problema y variante (se reinicia en cada barrido).
+                string csv = "results/results_" + vp->name + "_" + stem + ".csv";
+                string trig_csv = "results/triggers_" + vp->name + "_" + stem + ".csv";
                 if (fs::exists(csv)) fs::remove(csv);
                 if (fs::exists(trig_csv)) fs::remove(trig_csv);
                 ofstream o(csv, ios::out);
-                o << "run,variant,problem,best_value,nodes,elapsed,max_depth,avg_depth,optimal,triggers,triggers_depth,triggers_vol,vol_eval,vol_nonfinite\n";
+                o << "run,variant,problem,best_value,nodes,elapsed,max_depth,avg_depth,optimal,triggers,triggers_depth,triggers_vol,vol_eval,vol_nonfinite,core\n";
                 o.close();
                 ofstream ot(trig_csv, ios::out);
                 ot << "run,variant,problem,triggers_total,triggers_depth,triggers_vol,vol_eval,vol_nonfinite\n";
                 ot.close();
 
-                cout << " Ejecutando " << vp->name << " sobre " << prob_name << "...\n";
-                const int runs = 10;
-                unsigned hw = thread::hardware_concurrency();
-                unsigned max_parallel = hw ? std::max(1u, hw/2) : 4u;
-                // respetar un paralelo máximo de cores físicos si se detecta SMT (aprox hw/2)
-                if (hw > 0) {
-                    unsigned phys_approx = std::max(1u, hw/2);
-                    if (max_parallel > phys_approx) max_parallel = phys_approx;
+                for (int r = 0; r < runs; ++r)
+                    jobs.push_back({prob_path, prob_name, vp, r, t, csv, trig_csv});
+                remaining[prob_path] += runs;
+            }
+        }
+        if (jobs.empty()) {
+            cerr << "Nada que correr (todos los problemas excluidos).\n";
+            return 1;
+        }
+        // Más largas primero; a igual tiempo, en el orden de los problemas.
+        stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+            return a.expected > b.expected;
+        });
+
+        unsigned hw = thread::hardware_concurrency();
+        // Un worker por core físico (aprox hw/2 si hay SMT y no se fija).
+        unsigned max_parallel = !cores.empty() ? static_cast<unsigned>(cores.size())
+                                               : (hw ? std::max(1u, hw/2) : 4u);
+        isolate_if_needed(seed_base, max_parallel);
+
+        // Presupuesto de memoria de las corridas en curso. La memoria de una
+        // corrida es el VmRSS de su proceso (--isolate) o, en proceso, sus
+        // celdas vivas por los bytes por celda (crecimiento del VmRSS de
+        // este proceso sobre el total de celdas vivas, medido en cada nuevo
+        // máximo de celdas). Para admitir una corrida se usa el máximo visto
+        // en otras corridas del mismo problema.
+        size_t budget = mem_budget_gb > 0 ? static_cast<size_t>(mem_budget_gb * (1ull << 30))
+                                          : mem_available() / 10 * 8;
+        if (budget == 0) budget = numeric_limits<size_t>::max(); // sin /proc: sin límite
+        const size_t default_job_bytes = 256ull << 20; // problema sin corridas terminadas
+        const size_t min_job_bytes = 16ull << 20;      // corridas demasiado cortas para muestrear
+        cout << "Cola global: " << jobs.size() << " corridas, hasta " << max_parallel << " en paralelo";
+        if (budget != numeric_limits<size_t>::max()) cout << ", " << (budget >> 20) << " MB de memoria";
+        cout << " (--mem-budget=GB).\n";
+
+        struct Slot {
+            bool active = false;
+            size_t job = 0;
+            RunMemory mem;
+            size_t bytes = 0;  // uso estimado (último muestreo)
+            size_t peak = 0;
+        };
+        vector<unique_ptr<Slot>> slots;
+        for (unsigned i = 0; i < max_parallel; ++i) slots.emplace_back(new Slot());
+        map<string, size_t> problem_peak; // máximo por corrida, por problema
+        size_t bytes_per_cell = 512;
+        unsigned long max_live_cells = 0;
+        const size_t rss_base = read_rss("self");
+
+        vector<bool> taken(jobs.size(), false);
+        size_t first_free = 0;  // jobs[0..first_free) ya tomados
+        size_t done = 0;
+        bool finished = false;
+        mutex m;
+        condition_variable cv;
+
+        auto projected = [&](const Job& job) {
+            auto it = problem_peak.find(job.prob_path);
+            return it != problem_peak.end() ? it->second : default_job_bytes;
+        };
+
+        // Muestreo de la memoria de las corridas en curso.
+        auto sample = [&]() {
+            unsigned long cells = 0;
+            for (auto& sl : slots)
+                if (sl->active) cells += sl->mem.live_cells.load(memory_order_relaxed);
+            if (!isolate && cells > max_live_cells) {
+                max_live_cells = cells;
+                // Las celdas libres del pool (de corridas ya terminadas) siguen
+                // en el RSS pero no son de las corridas en curso.
+                size_t slabs = 0, idle = 0;
+                ibex::Cell::pool_usage(slabs, idle);
+                size_t rss = read_rss("self");
+                if (cells >= 10000 && rss > rss_base + idle)
+                    bytes_per_cell = std::max(bytes_per_cell, (rss - rss_base - idle) / cells);
+            }
+            for (auto& sl : slots) {
+                if (!sl->active) continue;
+                if (isolate) {
+                    pid_t pid = sl->mem.pid.load();
+                    if (pid > 0) sl->bytes = read_rss(to_string(pid));
+                } else {
+                    sl->bytes = sl->mem.live_cells.load(memory_order_relaxed) * bytes_per_cell;
                 }
-                if (max_parallel > 10) max_parallel = 10;
-                // Si es un problema hard, limitar aún más el paralelismo para evitar contención.
-                bool is_hard = (prob_path.find("/hard/") != string::npos);
-                if (is_hard && max_parallel > 2) max_parallel = 2;
-                struct Task { int r; };
-                vector<Task> tasks;
-                tasks.reserve(runs);
-                for (int r=0; r<runs; ++r) tasks.push_back({r});
-                atomic<size_t> next{0};
-                mutex m;
-                auto worker = [&]() {
-                    while (true) {
-                        size_t idx = next.fetch_add(1);
-                        if (idx >= tasks.size()) break;
-                        int r = tasks[idx].r;
-                        string cmd = vp->binary + " " + prob_path;
-                        long long seed = seed_for_run(r); // semilla controlada por usuario
-                        cmd += " --random-seed=" + std::to_string(seed);
-                        if (!vp->fd_mode.empty()) cmd += " --fd-mode=" + vp->fd_mode;
-                        if (vp->timeout > 0.0)   cmd += " --timeout=" + std::to_string(vp->timeout);
-                        RunResult res = run_ibex_base(cmd, vp->name, r);
-                        lock_guard<mutex> lk(m);
-                        ofstream out(csv, ios::app);
-                        ofstream outt(trig_csv, ios::app);
-                        if (!res.csv_line.empty()) {
-                            string line = res.csv_line;
-                            size_t first = line.find(',');
-                            size_t second = line.find(',', first+1);
-                            if (first!=string::npos && second!=string::npos) {
-                                line.insert(second, "," + prob_name);
-                            }
-                            out << line;
-                            if (line.back() != '\n') out << "\n";
-                            outt << r << "," << vp->name << "," << prob_name << ","
-                                 << (res.triggers_total>=0?res.triggers_total:0) << ","
-                                 << (res.triggers_depth>=0?res.triggers_depth:0) << ","
-                                 << (res.triggers_vol>=0?res.triggers_vol:0) << ","
-                                 << (res.vol_eval>=0?res.vol_eval:0) << ","
-                                 << (res.vol_nonfinite>=0?res.vol_nonfinite:0) << "\n";
-                        } else {
-                            out << r << "," << vp->name << "," << prob_name
-                                << ",nan,-1,-1,NA,NA,0,0,0,0,0,0\n";
-                            outt << r << "," << vp->name << "," << prob_name << ",0,0,0,0,0\n";
-                        }
+                sl->peak = std::max(sl->peak, sl->bytes);
+            }
+        };
+
+        auto worker = [&](size_t w) {
+            Slot& slot = *slots[w];
+            const string core = pin_worker(w);
+            unique_lock<mutex> lk(m);
+            while (true) {
+                while (first_free < jobs.size() && taken[first_free]) ++first_free;
+                if (first_free == jobs.size()) break;
+                // Memoria comprometida: lo medido o lo esperado de cada corrida.
+                size_t committed = 0;
+                bool running = false;
+                for (auto& sl : slots) {
+                    if (!sl->active) continue;
+                    running = true;
+                    committed += std::max(sl->bytes, projected(jobs[sl->job]));
+                }
+                // La más larga que cabe en el presupuesto (sin corridas en
+                // curso se admite cualquiera, para no quedar bloqueados).
+                size_t idx = jobs.size();
+                for (size_t i = first_free; i < jobs.size(); ++i) {
+                    if (taken[i]) continue;
+                    if (running && (committed > budget || projected(jobs[i]) > budget - committed)) continue;
+                    idx = i;
+                    break;
+                }
+                if (idx == jobs.size()) {
+                    cv.wait_for(lk, chrono::milliseconds(200));
+                    continue;
+                }
+                taken[idx] = true;
+                const Job& job = jobs[idx];
+                slot.active = true;
+                slot.job = idx;
+                slot.bytes = 0;
+                slot.peak = 0;
+                slot.mem.live_cells.store(0);
+                lk.unlock();
+
+                long long seed = seed_for_run(job.run); // semilla controlada por usuario
+                RunResult res = run_one(*job.variant, job.prob_path, seed, job.run, &slot.mem);
+
+                lk.lock();
+                slot.active = false;
+                size_t peak = std::max({slot.peak, res.peak_rss, min_job_bytes});
+                size_t& known = problem_peak[job.prob_path];
+                known = std::max(known, peak);
+                ofstream out(job.csv, ios::app);
+                ofstream outt(job.trig_csv, ios::app);
+                const string& vname = job.variant->name;
+                if (!res.csv_line.empty()) {
+                    string line = res.csv_line;
+                    size_t first = line.find(',');
+                    size_t second = line.find(',', first+1);
+                    if (first!=string::npos && second!=string::npos) {
+                        line.insert(second, "," + job.prob_name);
                     }
-                };
-                vector<thread> pool;
-                for (unsigned i=0;i<max_parallel;++i) pool.emplace_back(worker);
-                for (auto& th: pool) th.join();
+                    out << line << "," << core << "\n";
+                    outt << job.run << "," << vname << "," << job.prob_name << ","
+                         << (res.triggers_total>=0?res.triggers_total:0) << ","
+                         << (res.triggers_depth>=0?res.triggers_depth:0) << ","
+                         << (res.triggers_vol>=0?res.triggers_vol:0) << ","
+                         << (res.vol_eval>=0?res.vol_eval:0) << ","
+                         << (res.vol_nonfinite>=0?res.vol_nonfinite:0) << "\n";
+                } else {
+                    out << job.run << "," << vname << "," << job.prob_name
+                        << ",nan,-1,-1,NA,NA,0,0,0,0,0,0," << core << "\n";
+                    outt << job.run << "," << vname << "," << job.prob_name << ",0,0,0,0,0\n";
+                }
+                done++;
+                cout << " [" << done << "/" << jobs.size() << "] " << vname << " " << job.prob_name
+                     << " run " << job.run << "\n";
+                // Todas las corridas del problema terminaron: no se vuelve a leer.
+                if (--remaining[job.prob_path] == 0) systems.release(job.prob_path);
+                cv.notify_all();
             }
+            cv.notify_all();
         };
 
         cout << "Inicio batch: " << now_str() << "\n";
-        // Primero medium (si aplica), luego hard, secuencialmente por problema.
-        if (run_medium) {
-            for (const string& p : medium) run_problem(p);
-        }
-        if (run_hard) {
-            for (const string& p : hard)   run_problem(p);
+        thread sampler([&]() {
+            unique_lock<mutex> lk(m);
+            while (!finished) {
+                sample();
+                cv.notify_all();
+                cv.wait_for(lk, chrono::milliseconds(200));
+            }
+        });
+        vector<thread> pool;
+        for (unsigned i = 0; i < max_parallel; ++i) pool.emplace_back(worker, i);
+        for (auto& th : pool) th.join();
+        {
+            lock_guard<mutex> lk(m);
+            finished = true;
         }
+        cv.notify_all();
+        sampler.join();
         cout << "Fin batch: " << now_str() << "\n";
         cout << "Listo. Revisa results/results_<variante>_<problema>.csv\n";
         return 0;
@@ -392,6 +817,7 @@ int main() {
 
     unsigned hw = thread::hardware_concurrency();
     unsigned max_parallel = hw > 2 ? hw - 2 : 1;
+    if (!cores.empty()) max_parallel = std::min(max_parallel, static_cast<unsigned>(cores.size()));
     cout << "Max paralelo sugerido: " << max_parallel << "\n";
     int runs = 1;
     cout << "Cuantas corridas? (max " << max_parallel << "): ";
@@ -401,6 +827,7 @@ int main() {
     unsigned par = runs;
 
     long long seed_base = prompt_seed_base();
+    isolate_if_needed(seed_base, par);
     auto seed_for_run = make_seed_for_run(seed_base);
 
     fs::create_directories("results");
@@ -410,7 +837,7 @@ int main() {
     if (fs::exists(csv)) fs::remove(csv);
     if (fs::exists(trig_csv)) fs::remove(trig_csv);
     ofstream ofs(csv, ios::out);
-    ofs << "run,variant,problem,best_value,nodes,elapsed,max_depth,avg_depth,optimal,triggers,triggers_depth,triggers_vol,vol_eval,vol_nonfinite\n";
+    ofs << "run,variant,problem,best_value,nodes,elapsed,max_depth,avg_depth,optimal,triggers,triggers_depth,triggers_vol,vol_eval,vol_nonfinite,core\n";
     ofs.close();
     ofstream ot(trig_csv, ios::out);
     ot << "run,variant,problem,triggers_total,triggers_depth,triggers_vol,vol_eval,vol_nonfinite\n";
@@ -421,16 +848,9 @@ int main() {
     int launched = 0;
 
     auto worker = [&](int idx) {
-        string cmd = vinfo.binary + " " + problem;
+        const string core = pin_worker(idx);
         long long seed = seed_for_run(idx);
-        cmd += " --random-seed=" + std::to_string(seed);
-        if (!vinfo.fd_mode.empty()) {
-            cmd += " --fd-mode=" + vinfo.fd_mode;
-        }
-        if (vinfo.timeout > 0.0) {
-            cmd += " --timeout=" + std::to_string(vinfo.timeout);
-        }
-        RunResult res = run_ibex_base(cmd, vinfo.name, idx);
+        RunResult res = run_one(vinfo, problem, seed, idx, nullptr);
         lock_guard<mutex> lk(m);
         ofstream o(csv, ios::app);
         ofstream ot(trig_csv, ios::app);
@@ -442,8 +862,7 @@ int main() {
             if (first!=string::npos && second!=string::npos) {
                 line.insert(second, "," + prob_name);
             }
-            o << line;
-            if (line.back() != '\n') o << "\n";
+            o << line << "," << core << "\n";
             ot << idx << "," << vinfo.name << "," << prob_name << ","
                << (res.triggers_total>=0?res.triggers_total:0) << ","
                << (res.triggers_depth>=0?res.triggers_depth:0) << ","
@@ -452,7 +871,7 @@ int main() {
                << (res.vol_nonfinite>=0?res.vol_nonfinite:0) << "\n";
         } else {
             o << idx << "," << vinfo.name << "," << fs::path(problem).filename().string()
-              << ",NA,NA,NA,NA,NA,0,0,0,0,0,0\n";
+              << ",NA,NA,NA,NA,NA,0,0,0,0,0,0," << core << "\n";
             ot << idx << "," << vinfo.name << "," << fs::path(problem).filename().string() << ",0,0,0,0,0\n";
         }
     };
@@ -0,0 +1,257 @@
+// sharded_temp_buffer.cpp
+// Implementación de los shards y del robo de trabajo.
+
+#include "sharded_temp_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ibex;
+
+namespace {
+// Shard del hilo actual (asignado por bind); owner evita confundir instancias.
+thread_local const void* tl_owner = nullptr;
+thread_local size_t tl_shard = 0;
+}
+
+ShardedTempBuffer::ShardedTempBuffer(const ExtendedSystem& sys,
+                                     int goal_var,
+                                     const TempBuffer::Params& params,
+                                     CellBufferOptim& delegate,
+                                     size_t nb_shards) {
+    nb_shards = std::max<size_t>(1, nb_shards);
+    for (size_t i = 0; i < nb_shards; i++) {
+        TempBuffer::Params p = params;
+        p.rand_seed = params.rand_seed + i;
+        shards_.emplace_back(new Shard(sys, goal_var, p, delegate));
+    }
+}
+
+size_t ShardedTempBuffer::local_shard() const {
+    // Hilos sin bind (p.ej. Optimizer::start en el hilo principal) usan el shard 0.
+    return tl_owner == this ? tl_shard : 0;
+}
+
+void ShardedTempBuffer::bind(size_t worker) {
+    tl_owner = this;
+    tl_shard = worker % shards_.size();
+}
+
+void ShardedTempBuffer::refresh(Shard& s) {
+    s.min_lb.store(s.buffer.minimum());
+    s.count.store(s.buffer.size());
+}
+
+void ShardedTempBuffer::flush() {
+    for (auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->buffer.flush();
+        refresh(*s);
+    }
+    total_.store(0);
+    busy_.store(0);
+    stop_.store(false);
+}
+
+unsigned int ShardedTempBuffer::size() const {
+    return static_cast<unsigned int>(total_.load());
+}
+
+bool ShardedTempBuffer::empty() const {
+    return total_.load() == 0;
+}
+
+void ShardedTempBuffer::push(Cell* cell) {
+    if (!cell) return;
+    Shard& s = *shards_[local_shard()];
+    // total_ sube antes de insertar: nunca cuenta menos celdas que los shards.
+    total_++;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.buffer.push(cell);
+        refresh(s);
+    }
+    if (waiting_.load() > 0) wake_all();
+}
+
+Cell* ShardedTempBuffer::pop() {
+    for (auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (s->buffer.empty()) continue;
+        Cell* c = s->buffer.pop();
+        refresh(*s);
+        total_--;
+        return c;
+    }
+    return NULL;
+}
+
+Cell* ShardedTempBuffer::top() const {
+    for (auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (!s->buffer.empty()) return s->buffer.top();
+    }
+    return NULL;
+}
+
+double ShardedTempBuffer::minimum() const {
+    double m = POS_INFINITY;
+    for (auto& s : shards_) m = std::min(m, s->min_lb.load());
+    return m;
+}
+
+void ShardedTempBuffer::contract(double loup) {
+    // El loup se difunde a todos los shards: cada uno descarta lo suyo.
+    for (auto& s : shards_) {
+        if (s->count.load() == 0) continue;
+        std::lock_guard<std::mutex> lock(s->mutex);
+        size_t before = s->buffer.size();
+        s->buffer.contract(loup);
+        refresh(*s);
+        total_ -= before - s->buffer.size();
+    }
+}
+
+std::ostream& ShardedTempBuffer::print(std::ostream& os) const {
+    os << "ShardedTempBuffer(shards=" << shards_.size() << ", size=" << total_.load()
+       << ", steals=" << steals_.load() << ")";
+    return os;
+}
+
+Cell* ShardedTempBuffer::pop_local(Shard& s) {
+    if (s.count.load() == 0) return nullptr;
+    Cell* c;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.buffer.empty()) return nullptr;
+        // top() antes de pop(), como Optimizer::optimize.
+        c = s.buffer.top();
+        s.buffer.pop();
+        refresh(s);
+    }
+    total_--;
+    return c;
+}
+
+Cell* ShardedTempBuffer::steal(size_t self) {
+    // Víctima: el shard más cargado (lectura aproximada, sin locks).
+    size_t victim = self;
+    size_t best = 0;
+    for (size_t i = 1; i < shards_.size(); i++) {
+        size_t j = (self + i) % shards_.size();
+        size_t n = shards_[j]->count.load();
+        if (n > best) { best = n; victim = j; }
+    }
+    if (victim == self) return nullptr;
+
+    // Se roban las mejores celdas según la selección térmica de la víctima,
+    // sin mover su piso de profundidad ni su referencia de volumen.
+    std::vector<Cell*> batch;
+    {
+        Shard& v = *shards_[victim];
+        std::lock_guard<std::mutex> lock(v.mutex);
+        size_t k = std::min(max_steal, std::max<size_t>(1, v.buffer.size() / 2));
+        while (k-- > 0 && !v.buffer.empty()) batch.push_back(v.buffer.extract_best());
+        refresh(v);
+    }
+    if (batch.empty()) return nullptr;
+    steals_++;
+
+    if (batch.size() > 1) {
+        Shard& own = *shards_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        for (size_t i = 1; i < batch.size(); i++) own.buffer.push(batch[i]);
+        refresh(own);
+    }
+    total_--;
+    return batch.front();
+}
+
+Cell* ShardedTempBuffer::steal_better(size_t self) {
+    // Robo por calidad: si otro shard guarda una cota menor que la del propio,
+    // se toma de él su celda de menor cota. Sin esto las celdas de menor lb
+    // quedan varadas en el shard de un hilo desplanificado y el uplo no sube
+    // hasta que ese hilo vuelve. Pero en régimen casi siempre hay un shard
+    // con una cota algo menor: robar ante cualquier diferencia haría que
+    // todos los workers extrajeran de ese shard (contención y sin selección
+    // térmica propia). Sólo se roba si la brecha es grande o si el shard
+    // propio lleva quality_patience extracciones por detrás.
+    Shard& own = *shards_[self];
+    if (own.count.load() == 0) return nullptr; // lo resuelve steal()
+    size_t victim = self;
+    double own_lb = own.min_lb.load();
+    double best = own_lb;
+    for (size_t i = 0; i < shards_.size(); i++) {
+        double m = shards_[i]->min_lb.load();
+        if (m < best) { best = m; victim = i; }
+    }
+    if (victim == self) {
+        own.behind = 0;
+        return nullptr;
+    }
+    double gap = own_lb - best;
+    if (++own.behind < quality_patience && !(gap > quality_gap * std::max(1.0, std::fabs(best))))
+        return nullptr;
+    own.behind = 0;
+    Cell* c = nullptr;
+    {
+        Shard& v = *shards_[victim];
+        std::lock_guard<std::mutex> lock(v.mutex);
+        if (v.buffer.empty()) return nullptr;
+        c = v.buffer.extract_min_lb();
+        refresh(v);
+    }
+    total_--;
+    steals_++;
+    return c;
+}
+
+Cell* ShardedTempBuffer::take() {
+    size_t self = local_shard();
+    while (!stop_.load()) {
+        // busy_ sube antes de descontar total_: nunca se observa
+        // total_ == 0 && busy_ == 0 con una celda en vuelo.
+        busy_++;
+        // Lo normal es la selección térmica del shard propio; el robo por
+        // calidad sólo la reemplaza cuando el shard quedó rezagado.
+        Cell* c = steal_better(self);
+        if (!c) c = pop_local(*shards_[self]);
+        if (!c) c = steal(self);
+        if (c) return c;
+        release();
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        waiting_++;
+        idle_cv_.wait(lock, [this] { return stop_.load() || total_.load() > 0 || busy_.load() == 0; });
+        waiting_--;
+        if (total_.load() == 0 && busy_.load() == 0) {
+            // Nadie tiene celdas ni puede generarlas: fin de la búsqueda.
+            stop_.store(true);
+            idle_cv_.notify_all();
+        }
+    }
+    return nullptr;
+}
+
+void ShardedTempBuffer::release() {
+    if (--busy_ == 0 && total_.load() == 0) wake_all();
+}
+
+void ShardedTempBuffer::stop() {
+    stop_.store(true);
+    wake_all();
+}
+
+void ShardedTempBuffer::wake_all() {
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    idle_cv_.notify_all();
+}
+
+TempBuffer::Stats ShardedTempBuffer::stats() const {
+    TempBuffer::Stats st;
+    for (auto& s : shards_) {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        st += s->buffer.stats();
+    }
+    return st;
+}
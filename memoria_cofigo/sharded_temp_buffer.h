@@ -0,0 +1,90 @@
+// sharded_temp_buffer.h
+// TempBuffer repartido en shards, uno por worker del modo paralelo. Cada
+// worker empuja y extrae de su propio shard (selección térmica local); si su
+// shard se vacía roba las mejores celdas del shard más cargado, y si otro
+// shard tiene una cota inferior claramente menor que la suya (o la ha tenido
+// durante varias extracciones seguidas) le quita su celda de menor cota.
+
+#pragma once
+
+#include "parallel_optimizer.h"
+#include "temp_buffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ShardedTempBuffer : public SharedCellBuffer {
+public:
+    // Un TempBuffer por shard, con los mismos parámetros salvo la semilla
+    // (rand_seed + índice del shard). El delegado sólo se usa en flush().
+    ShardedTempBuffer(const ibex::ExtendedSystem& sys,
+                      int goal_var,
+                      const TempBuffer::Params& params,
+                      ibex::CellBufferOptim& delegate,
+                      size_t nb_shards);
+
+    void flush() override;
+    unsigned int size() const override;
+    bool empty() const override;
+    void push(ibex::Cell* cell) override;
+    ibex::Cell* pop() override;
+    ibex::Cell* top() const override;
+    // Mínimo de los mínimos cacheados de cada shard: O(shards) y sin locks.
+    // Las celdas que están cambiando de shard en un robo no se ven; sólo es
+    // exacto con los workers detenidos (Optimizer::finish).
+    double minimum() const override;
+    void contract(double loup) override;
+    std::ostream& print(std::ostream& os) const override;
+
+    void bind(size_t worker) override;
+    ibex::Cell* take() override;
+    void release() override;
+    void stop() override;
+
+    // Contadores de disparos sumados sobre los shards.
+    TempBuffer::Stats stats() const;
+    size_t steal_count() const { return steals_.load(); }
+
+private:
+    // Máximo de celdas movidas en un robo (la mitad del shard víctima).
+    static constexpr size_t max_steal = 64;
+    // Robo por calidad: brecha relativa de cota inferior que lo dispara de
+    // inmediato, y extracciones seguidas con una brecha menor que también.
+    static constexpr double quality_gap = 0.05;
+    static constexpr unsigned int quality_patience = 32;
+
+    struct Shard {
+        Shard(const ibex::ExtendedSystem& sys, int goal_var,
+              const TempBuffer::Params& params, ibex::CellBufferOptim& delegate)
+            : buffer(sys, goal_var, params, delegate) {}
+
+        mutable std::mutex mutex;
+        TempBuffer buffer;
+        // Copias de buffer.minimum() / buffer.size(), legibles sin lock.
+        std::atomic<double> min_lb{ibex::POS_INFINITY};
+        std::atomic<size_t> count{0};
+        // Extracciones seguidas con otro shard de menor cota (sólo lo toca
+        // el worker dueño del shard).
+        unsigned int behind = 0;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    // Celdas en los shards más las que están en tránsito durante un robo.
+    std::atomic<size_t> total_{0};
+    std::atomic<unsigned int> busy_{0};
+    std::atomic<unsigned int> waiting_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> steals_{0};
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+
+    size_t local_shard() const;
+    void refresh(Shard& s);
+    ibex::Cell* pop_local(Shard& s);
+    ibex::Cell* steal(size_t self);
+    ibex::Cell* steal_better(size_t self);
+    void wake_all();
+};
@@ -15,7 +15,9 @@ TempBuffer::TempBuffer(const ExtendedSystem& sys,
                        int goal_var,
                        const Params& params,
                        CellBufferOptim& delegate)
-: delegate_(delegate), goal_var_(goal_var), params_(params) {
+: delegate_(delegate), goal_var_(goal_var), params_(params),
+  lb_heap_(LbTraits{&slots_}),
+  lb_max_heap_(LbMaxTraits{&slots_}) {
     (void) sys;
     Cell::set_temp_params(params.k, params.rand_k, params.rand_seed, params.T0);
     debug_triggers_ = std::getenv("FD_TRIGGER_DEBUG") != nullptr;
@@ -30,17 +32,21 @@ TempBuffer::~TempBuffer() {
 
 void TempBuffer::flush() {
     // Limpia nuestras estructuras y el delegado por si acumula estado.
-    for (auto& ptr : items_) {
-        if (ptr && ptr->alive && ptr->cell) {
-            delete ptr->cell;
+    for (auto& item : slots_) {
+        if (item.alive && item.cell) {
+            delete item.cell;
         }
     }
-    items_.clear();
-    score_heap_ = {};
-    lb_heap_ = {};
+    for (auto& h : depth_heaps_) h.clear();
+    std::fill(depth_tree_.begin(), depth_tree_.end(), UINT32_MAX);
+    lb_heap_.clear();
+    lb_max_heap_.clear();
+    slots_.clear();
+    free_slots_.clear();
+    next_seq_ = 0;
     alive_count_ = 0;
     depth_floor_ = 0;
-    current_logV_ref_ = params.log_V0_ref;
+    current_logV_ref_ = params_.log_V0_ref;
     trigger_count_ = depth_trigger_count_ = vol_trigger_count_ = 0;
     vol_eval_count_ = vol_nonfinite_count_ = 0;
     delegate_.flush();
@@ -49,17 +55,6 @@ void TempBuffer::flush() {
 unsigned int TempBuffer::size() const { return static_cast<unsigned int>(alive_count_); }
 bool TempBuffer::empty() const { return alive_count_ == 0; }
 
-double TempBuffer::log_volume(const IntervalVector& box) const {
-    double acc = 0.0;
-    for (int i = 0; i < box.size(); ++i) {
-        double w = box[i].diam();
-        if (!std::isfinite(w) || w <= 0.0) return POS_INFINITY;
-        w = std::max(1e-300, std::min(1e300, w));
-        acc += std::log10(w);
-    }
-    return acc;
-}
-
 double TempBuffer::compute_score(const Item& item) {
     double score = item.lb;
 
@@ -87,27 +82,101 @@ double TempBuffer::compute_score(const Item& item) {
     return score;
 }
 
-template <typename Heap>
-void TempBuffer::prune_heap(Heap& h) const {
-    while (!h.empty()) {
-        size_t idx = h.top().second;
-        if (idx < items_.size() && items_[idx] && items_[idx]->alive) break;
-        h.pop();
+uint32_t TempBuffer::acquire_slot() {
+    if (!free_slots_.empty()) {
+        uint32_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
     }
+    slots_.emplace_back();
+    return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+void TempBuffer::release_slot(uint32_t slot) {
+    Item& item = slots_[slot];
+    item.alive = false;
+    item.cell = nullptr;
+    free_slots_.push_back(slot);
 }
 
-void TempBuffer::prune_heaps() const {
-    prune_heap(score_heap_);
-    prune_heap(lb_heap_);
+void TempBuffer::unlink(uint32_t slot) {
+    unsigned int depth = slots_[slot].depth;
+    if (depth < depth_heaps_.size() && depth_heaps_[depth].contains(slot)) {
+        depth_heaps_[depth].erase(slot);
+        update_depth_tree(depth);
+    }
+    if (lb_heap_.contains(slot)) lb_heap_.erase(slot);
+    if (lb_max_heap_.contains(slot)) lb_max_heap_.erase(slot);
 }
 
-void TempBuffer::drop_item(Item& item) {
+void TempBuffer::drop_item(uint32_t slot) {
+    Item& item = slots_[slot];
     if (!item.alive) return;
-    item.alive = false;
     if (item.cell) delete item.cell;
+    unlink(slot);
+    release_slot(slot);
     if (alive_count_ > 0) alive_count_--;
 }
 
+bool TempBuffer::score_before(uint32_t a, uint32_t b) const {
+    if (b == UINT32_MAX) return a != UINT32_MAX;
+    if (a == UINT32_MAX) return false;
+    double sa = slots_[a].score, sb = slots_[b].score;
+    return sa < sb || (sa == sb && slots_[a].seq < slots_[b].seq);
+}
+
+void TempBuffer::grow_depth_tree(unsigned int depth) {
+    while (depth_heaps_.size() <= depth) depth_heaps_.emplace_back(ScoreTraits{&slots_});
+    if (depth < tree_leaves_) return;
+    size_t leaves = tree_leaves_ ? tree_leaves_ : 64;
+    while (leaves <= depth) leaves *= 2;
+    tree_leaves_ = leaves;
+    depth_tree_.assign(2 * leaves, UINT32_MAX);
+    for (size_t d = 0; d < depth_heaps_.size(); ++d) {
+        if (!depth_heaps_[d].empty()) depth_tree_[leaves + d] = depth_heaps_[d].top();
+    }
+    for (size_t i = leaves - 1; i >= 1; --i) {
+        uint32_t l = depth_tree_[2 * i], r = depth_tree_[2 * i + 1];
+        depth_tree_[i] = score_before(r, l) ? r : l;
+    }
+}
+
+void TempBuffer::update_depth_tree(unsigned int depth) {
+    size_t i = tree_leaves_ + depth;
+    depth_tree_[i] = depth_heaps_[depth].empty() ? UINT32_MAX : depth_heaps_[depth].top();
+    for (i /= 2; i >= 1; i /= 2) {
+        uint32_t l = depth_tree_[2 * i], r = depth_tree_[2 * i + 1];
+        depth_tree_[i] = score_before(r, l) ? r : l;
+    }
+}
+
+uint32_t TempBuffer::best_up_to(unsigned int max_depth) const {
+    // Mínimo de prefijo sobre las hojas [0, max_depth] del árbol de torneo.
+    size_t hi = std::min<size_t>(max_depth, tree_leaves_ - 1);
+    uint32_t best = UINT32_MAX;
+    for (size_t l = tree_leaves_, r = tree_leaves_ + hi + 1; l < r; l /= 2, r /= 2) {
+        if (l & 1) { if (score_before(depth_tree_[l], best)) best = depth_tree_[l]; l++; }
+        if (r & 1) { --r; if (score_before(depth_tree_[r], best)) best = depth_tree_[r]; }
+    }
+    return best;
+}
+
+unsigned int TempBuffer::min_live_depth() const {
+    size_t i = 1;
+    while (i < tree_leaves_) i = (depth_tree_[2 * i] != UINT32_MAX) ? 2 * i : 2 * i + 1;
+    return static_cast<unsigned int>(i - tree_leaves_);
+}
+
+uint32_t TempBuffer::select(unsigned int& floor) const {
+    if (alive_count_ == 0) return UINT32_MAX;
+    if (params_.depth_cut <= 0) return depth_tree_[1];
+    uint32_t best = best_up_to(floor + static_cast<unsigned int>(params_.depth_cut));
+    if (best != UINT32_MAX) return best;
+    // Todos superan el límite de profundidad: elevar el piso y aceptar el mejor global.
+    floor = min_live_depth();
+    return depth_tree_[1];
+}
+
 void TempBuffer::push(Cell* cell) {
     if (!cell) return;
 
@@ -130,11 +199,14 @@ void TempBuffer::push(Cell* cell) {
 
         if (!cell->box.is_unbounded()) {
             vol_eval_count_++;
+            // Volumen cacheado en la celda (actualizado en O(1) al bisectar,
+            // o recalculado en una sola pasada vectorizada junto con los anchos
+            // no finitos que alimentan vol_nonfinite_count_).
+            item.log_volume = cell->get_log_volume();
             // Referencia local: el último nodo seleccionado (current_logV_ref_).
             double log_ref = current_logV_ref_;
             if (!std::isfinite(log_ref)) log_ref = params_.log_V0_ref;
             if (!std::isfinite(log_ref)) log_ref = item.log_volume;
-            item.log_volume = log_volume(cell->box);
             double vr = params_.vol_ratio_cut;
             if (params_.vol_cut_jitter > 0.0) {
                 double n = rand_unit();
@@ -168,92 +240,89 @@ void TempBuffer::push(Cell* cell) {
 
     item.score = compute_score(item);
 
-    size_t idx = items_.size();
-    items_.push_back(std::make_unique<Item>(item));
-    score_heap_.push({item.score, idx});
-    lb_heap_.push({item.lb, idx});
+    uint32_t slot = acquire_slot();
+    item.seq = next_seq_++;
+    item.alive = true;
+    slots_[slot] = item;
+    grow_depth_tree(item.depth);
+    depth_heaps_[item.depth].push(slot);
+    update_depth_tree(item.depth);
+    lb_heap_.push(slot);
+    lb_max_heap_.push(slot);
     alive_count_++;
 }
 
 Cell* TempBuffer::pop() {
-    prune_heap(score_heap_);
-    if (score_heap_.empty()) return NULL;
-
-    double depth_limit = params_.depth_cut > 0 ? static_cast<double>(depth_floor_ + params_.depth_cut) : POS_INFINITY;
-    std::vector<HeapEntry> deferred;
-    size_t attempts = 0;
-    size_t selected_idx = static_cast<size_t>(-1);
-
-    auto accept = [&](size_t idx)->bool {
-        if (idx >= items_.size() || !items_[idx] || !items_[idx]->alive) return false;
-        if (params_.depth_cut>0 && items_[idx]->depth > depth_limit) return false;
-        return true;
-    };
-
-    while (!score_heap_.empty() && attempts < alive_count_) {
-        auto top = score_heap_.top(); score_heap_.pop();
-        size_t idx = top.second;
-        attempts++;
-        if (accept(idx)) { selected_idx = idx; break; }
-        if (idx < items_.size() && items_[idx] && items_[idx]->alive) deferred.push_back(top);
-    }
-
-    if (selected_idx == static_cast<size_t>(-1)) {
-        // Todos superan depth_limit: elevar el piso y aceptar el mejor diferido.
-        unsigned int min_depth = UINT_MAX;
-        for (auto& e : deferred) {
-            size_t idx = e.second;
-            if (idx < items_.size() && items_[idx]) {
-                min_depth = std::min(min_depth, items_[idx]->depth);
-            }
-        }
-        if (min_depth!=UINT_MAX) depth_floor_ = min_depth;
-        if (!deferred.empty()) {
-            selected_idx = deferred.front().second;
-            deferred.erase(deferred.begin());
-        } else if (!score_heap_.empty()) {
-            selected_idx = score_heap_.top().second;
-            score_heap_.pop();
-        }
-    }
-
-    // Reinsertar diferidos que no fueron elegidos
-    for (auto& e : deferred) score_heap_.push(e);
+    uint32_t selected = select(depth_floor_);
+    if (selected == UINT32_MAX) return NULL;
 
-    if (selected_idx == static_cast<size_t>(-1) || selected_idx >= items_.size() || !items_[selected_idx]) return NULL;
-    Item& item = *items_[selected_idx];
-    if (!item.alive) return NULL;
-    item.alive = false;
-    prune_heap(lb_heap_);
-    if (alive_count_ > 0) alive_count_--;
+    Item& item = slots_[selected];
+    Cell* cell = item.cell;
     // Actualizar referencia de volumen para hijos de este nodo.
     current_logV_ref_ = item.log_volume;
-    return item.cell;
+    unlink(selected);
+    release_slot(selected);
+    if (alive_count_ > 0) alive_count_--;
+    return cell;
 }
 
 Cell* TempBuffer::top() const {
-    prune_heap(score_heap_);
-    if (score_heap_.empty()) return NULL;
-    size_t idx = score_heap_.top().second;
-    if (idx >= items_.size() || !items_[idx]) return NULL;
-    return items_[idx]->cell;
+    // Misma selección que pop() (sin mover el piso), para que el optimizador
+    // bisecte exactamente la celda que luego extrae.
+    unsigned int floor = depth_floor_;
+    uint32_t selected = select(floor);
+    if (selected == UINT32_MAX) return NULL;
+    return slots_[selected].cell;
+}
+
+Cell* TempBuffer::extract_best() {
+    unsigned int floor = depth_floor_;
+    uint32_t selected = select(floor);
+    if (selected == UINT32_MAX) return NULL;
+    Cell* cell = slots_[selected].cell;
+    unlink(selected);
+    release_slot(selected);
+    if (alive_count_ > 0) alive_count_--;
+    return cell;
+}
+
+Cell* TempBuffer::extract_min_lb() {
+    if (lb_heap_.empty()) return NULL;
+    uint32_t selected = lb_heap_.top();
+    Cell* cell = slots_[selected].cell;
+    unlink(selected);
+    release_slot(selected);
+    if (alive_count_ > 0) alive_count_--;
+    return cell;
+}
+
+void TempBuffer::visit(const std::function<void(const Cell&)>& f) const {
+    for (const Item& item : slots_)
+        if (item.alive) f(*item.cell);
+}
+
+TempBuffer::Stats TempBuffer::stats() const {
+    Stats st;
+    st.triggers = trigger_count_;
+    st.depth_triggers = depth_trigger_count_;
+    st.vol_triggers = vol_trigger_count_;
+    st.vol_eval = vol_eval_count_;
+    st.vol_nonfinite = vol_nonfinite_count_;
+    return st;
 }
 
 double TempBuffer::minimum() const {
-    if (alive_count_ == 0) return POS_INFINITY;
-    prune_heap(lb_heap_);
     if (lb_heap_.empty()) return POS_INFINITY;
-    return lb_heap_.top().first;
+    return slots_[lb_heap_.top()].lb;
 }
 
 void TempBuffer::contract(double loup) {
-    for (auto& ptr : items_) {
-        if (!ptr || !ptr->alive) continue;
-        if (ptr->lb > loup) {
-            drop_item(*ptr);
-        }
+    // Sólo se visitan las celdas descartadas: O(k log n) con k = celdas con lb > loup.
+    while (!lb_max_heap_.empty()) {
+        uint32_t slot = lb_max_heap_.top();
+        if (!(slots_[slot].lb > loup)) break;
+        drop_item(slot);
     }
-    prune_heaps();
 }
 
 std::ostream& TempBuffer::print(std::ostream& os) const {
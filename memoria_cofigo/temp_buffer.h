@@ -5,15 +5,14 @@
 #pragma once
 
 #include "ibex.h"
+#include "indexed_heap.h"
 #include <cstdint>
 #include <functional>
-#include <memory>
-#include <queue>
 #include <random>
 #include <utility>
 #include <vector>
 
-class TempBuffer : public ibex::CellBufferOptim {
+class TempBuffer : public ibex::CellBufferOptim, public ibex::CellBufferVisitable {
 public:
     struct Params {
         double k = 10.0;
@@ -36,6 +35,24 @@ public:
         int tie_break_mode = 0; // se ignora; se mantiene por compatibilidad
     };
 
+    // Contadores de disparos (agregables entre shards).
+    struct Stats {
+        size_t triggers = 0;
+        size_t depth_triggers = 0;
+        size_t vol_triggers = 0;
+        size_t vol_eval = 0;
+        size_t vol_nonfinite = 0;
+
+        Stats& operator+=(const Stats& o) {
+            triggers += o.triggers;
+            depth_triggers += o.depth_triggers;
+            vol_triggers += o.vol_triggers;
+            vol_eval += o.vol_eval;
+            vol_nonfinite += o.vol_nonfinite;
+            return *this;
+        }
+    };
+
     TempBuffer(const ibex::ExtendedSystem& sys,
                int goal_var,
                const Params& params,
@@ -52,15 +69,72 @@ public:
     void contract(double loup) override;
     std::ostream& print(std::ostream& os) const override;
 
+    // Saca la celda que elegiría pop() pero sin mover el piso de profundidad
+    // ni la referencia de volumen (robo desde otro shard).
+    ibex::Cell* extract_best();
+    // Saca la celda de menor cota inferior, con el mismo cuidado (robo por
+    // calidad: rescata la celda que frena el uplo global).
+    ibex::Cell* extract_min_lb();
+
+    // Recorre las celdas vivas sin tocar el estado de selección (checkpoints).
+    void visit(const std::function<void(const ibex::Cell&)>& f) const override;
+
 private:
+    struct Item {
+        ibex::Cell* cell = nullptr;
+        double lb = ibex::POS_INFINITY;
+        double score = ibex::POS_INFINITY;
+        double vol_ratio = ibex::POS_INFINITY;
+        double log_volume = ibex::POS_INFINITY;
+        unsigned int depth = 0;
+        // Orden de inserción: desempata scores y cotas iguales (los slots se
+        // reciclan, su índice no sirve para eso).
+        uint64_t seq = 0;
+        uint32_t score_pos = UINT32_MAX; // posición en depth_heaps_[depth]
+        uint32_t lb_pos = UINT32_MAX;    // posición en lb_heap_
+        uint32_t lb_max_pos = UINT32_MAX; // posición en lb_max_heap_
+        bool alive = false;
+    };
+
+    // Traits de IndexedHeap: la posición vive dentro del propio Item, así
+    // pop/contract/drop_item sacan la entrada del heap de forma inmediata.
+    struct ScoreTraits {
+        std::vector<Item>* slots = nullptr;
+        double key(uint32_t s) const { return (*slots)[s].score; }
+        uint64_t tie(uint32_t s) const { return (*slots)[s].seq; }
+        uint32_t& pos(uint32_t s) const { return (*slots)[s].score_pos; }
+    };
+    struct LbTraits {
+        std::vector<Item>* slots = nullptr;
+        double key(uint32_t s) const { return (*slots)[s].lb; }
+        uint64_t tie(uint32_t s) const { return (*slots)[s].seq; }
+        uint32_t& pos(uint32_t s) const { return (*slots)[s].lb_pos; }
+    };
+    // Orden inverso por lb: contract(loup) sólo recorre la cima (lb > loup).
+    struct LbMaxTraits {
+        std::vector<Item>* slots = nullptr;
+        double key(uint32_t s) const { return -(*slots)[s].lb; }
+        uint64_t tie(uint32_t s) const { return (*slots)[s].seq; }
+        uint32_t& pos(uint32_t s) const { return (*slots)[s].lb_max_pos; }
+    };
+
     ibex::CellBufferOptim& delegate_;
     int goal_var_;
     Params params_;
-    std::vector<std::unique_ptr<struct Item>> items_;
-    using HeapEntry = std::pair<double, size_t>;
-    mutable std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> score_heap_;
-    mutable std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> lb_heap_;
+    // Pool de slots: los slots muertos se reciclan vía free_slots_, así la
+    // memoria es proporcional a las celdas vivas y no al total histórico.
+    std::vector<Item> slots_;
+    std::vector<uint32_t> free_slots_;
+    // Selección en dos niveles: un heap de score por profundidad y un árbol de
+    // torneo sobre las cimas de esos heaps. El mejor nodo elegible (depth <=
+    // depth_floor_ + depth_cut) es un mínimo de prefijo en O(log D).
+    std::vector<IndexedHeap<ScoreTraits>> depth_heaps_;
+    std::vector<uint32_t> depth_tree_;
+    size_t tree_leaves_ = 0;
+    IndexedHeap<LbTraits> lb_heap_;
+    IndexedHeap<LbMaxTraits> lb_max_heap_;
     size_t alive_count_ = 0;
+    uint64_t next_seq_ = 0;
     unsigned int depth_floor_ = 0;
     double current_logV_ref_ = ibex::POS_INFINITY;
     size_t trigger_count_ = 0;
@@ -73,23 +147,18 @@ private:
     std::mt19937_64 rng_;
     std::uniform_real_distribution<double> noise_dist_{-0.5, 0.5};
 
-    struct Item {
-        ibex::Cell* cell = nullptr;
-        double lb = ibex::POS_INFINITY;
-        double score = ibex::POS_INFINITY;
-        double vol_ratio = ibex::POS_INFINITY;
-        double log_volume = ibex::POS_INFINITY;
-        unsigned int depth = 0;
-        bool alive = true;
-    };
-
     double rand_unit() { return noise_dist_(rng_); }
-    double log_volume(const ibex::IntervalVector& box) const;
     double compute_score(const Item& item);
-    template <typename Heap>
-    void prune_heap(Heap& h) const;
-    void prune_heaps() const;
-    void drop_item(Item& item);
+    uint32_t acquire_slot();
+    void release_slot(uint32_t slot);
+    void unlink(uint32_t slot);
+    bool score_before(uint32_t a, uint32_t b) const;
+    void grow_depth_tree(unsigned int depth);
+    void update_depth_tree(unsigned int depth);
+    uint32_t best_up_to(unsigned int max_depth) const;
+    unsigned int min_live_depth() const;
+    uint32_t select(unsigned int& floor) const;
+    void drop_item(uint32_t slot);
 
 public:
     size_t trigger_count() const { return trigger_count_; }
@@ -97,4 +166,5 @@ public:
     size_t vol_trigger_count() const { return vol_trigger_count_; }
     size_t vol_eval_count() const { return vol_eval_count_; }
     size_t vol_nonfinite_count() const { return vol_nonfinite_count_; }
+    Stats stats() const;
 };